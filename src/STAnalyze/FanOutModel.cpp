@@ -0,0 +1,162 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include "FanOutModel.h"
+#include "ScenarioAnalysis.h"
+#include "STLib/SpatialGrid.h"
+
+namespace
+{
+    struct ClientReplay
+    {
+        pClient Client;
+        QVector<ReplayPacket> Packets;
+        int EndTime;
+    };
+}
+
+FanOutModel::FanOutModel(int PilotRange)
+    : mPilotRange(PilotRange), mStartTime(0), mPositions(0), mMessages(0), mBytes(0)
+{
+}
+
+void FanOutModel::Run(const ClientContainer &Cont)
+{
+    QVector<ClientReplay> Replays(Cont.size());
+    for (int i = 0; i < Cont.size(); i++)
+    {
+        Replays[i].Client = Cont[i];
+    }
+    QtConcurrent::blockingMap(Replays, [](ClientReplay &Replay)
+    {
+        Replay.Packets = ReplayClient(*Replay.Client, Replay.EndTime);
+    });
+
+    int Duration = 0;
+    for (const ClientReplay &Replay : Replays)
+    {
+        Duration = qMax(Duration, Replay.EndTime);
+    }
+    int Seconds = Duration / 1000 + 1;
+    mStartTime = Cont.GetStartTime();
+    mPositions = 0;
+    mMessages = 0;
+    mBytes = 0;
+    mSecondPositions.fill(0, Seconds);
+    mSecondMessages.fill(0, Seconds);
+    mSecondBytes.fill(0, Seconds);
+
+    // merge the clients by time, the packets of every client are in order
+    typedef QPair<int, int> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> Heads;
+    QVector<int> Cursor(Replays.size(), 0);
+    for (int i = 0; i < Replays.size(); i++)
+    {
+        if (!Replays[i].Packets.isEmpty())
+        {
+            Heads.push(qMakePair(Replays[i].Packets.first().Time, i));
+        }
+    }
+
+    SpatialGrid Grid;
+    QHash<QString, int> Online;
+    while (!Heads.empty())
+    {
+        int Index = Heads.top().second;
+        Heads.pop();
+        const ClientReplay &Replay = Replays[Index];
+        const ReplayPacket &Packet = Replay.Packets[Cursor[Index]++];
+        if (Cursor[Index] < Replay.Packets.size())
+        {
+            Heads.push(qMakePair(Replay.Packets[Cursor[Index]].Time, Index));
+        }
+
+        int Second = Packet.Time / 1000;
+        int Receivers = 0;
+        switch (Packet.Reason)
+        {
+        case AddAirplaneReason:
+        case AddATCReason:
+            Online.insert(Replay.Client->GetCallsign(), Index);
+            break;
+        case RemoveAirplaneReason:
+        case RemoveATCReason:
+            Online.remove(Replay.Client->GetCallsign());
+            Grid.Remove(Index);
+            break;
+        case PositionAirplaneReason:
+        {
+            VatPilotPosition Pos = static_cast<const AirplanePositionUpdate *>(Packet.Update)->GetPosUpdate(Packet.Step);
+            Grid.Insert(Index, Pos.latitude, Pos.longitude, mPilotRange);
+            Receivers = Grid.CountCovering(Pos.latitude, Pos.longitude, Index);
+            mPositions++;
+            mSecondPositions[Second]++;
+            break;
+        }
+        case PositionATCReason:
+        {
+            const ControllerPositionUpdate *Pos = static_cast<const ControllerPositionUpdate *>(Packet.Update);
+            Grid.Insert(Index, Pos->GetLat(), Pos->GetLong(), Pos->GetVisRange());
+            Receivers = Grid.CountCovering(Pos->GetLat(), Pos->GetLong(), Index);
+            mPositions++;
+            mSecondPositions[Second]++;
+            break;
+        }
+        case TextMsg:
+        {
+            const TextMessageUpdate *Text = static_cast<const TextMessageUpdate *>(Packet.Update);
+            Receivers = Online.contains(Text->GetReceiver()) ? 1 : 0;
+            break;
+        }
+        default:
+            break;
+        }
+        mMessages += Receivers;
+        mBytes += static_cast<qint64>(Receivers) * Packet.Bytes;
+        mSecondMessages[Second] += Receivers;
+        mSecondBytes[Second] += static_cast<qint64>(Receivers) * Packet.Bytes;
+    }
+}
+
+void FanOutModel::Report(int Top) const
+{
+    int Seconds = mSecondMessages.size();
+    qint64 PeakMessages = 0;
+    qint64 PeakBytes = 0;
+    for (int i = 0; i < Seconds; i++)
+    {
+        PeakMessages = qMax(PeakMessages, mSecondMessages[i]);
+        PeakBytes = qMax(PeakBytes, mSecondBytes[i]);
+    }
+
+    Print("\nFan-out (pilot range %d nm)", mPilotRange);
+    Print("  Positions:        %lld", mPositions);
+    Print("  Server messages:  %lld, avg %.1f/s, peak %lld/s", mMessages,
+          Seconds > 0 ? mMessages / double(Seconds) : 0.0, PeakMessages);
+    Print("  Receivers:        %.2f per position", mPositions > 0 ? mMessages / double(mPositions) : 0.0);
+    Print("  Server bytes:     avg %.1f B/s, peak %lld B/s", Seconds > 0 ? mBytes / double(Seconds) : 0.0,
+          PeakBytes);
+
+    QVector<int> Order(Seconds);
+    for (int i = 0; i < Seconds; i++)
+    {
+        Order[i] = i;
+    }
+    Top = qMin(Top, Seconds);
+    std::partial_sort(Order.begin(), Order.begin() + Top, Order.end(), [this](int a, int b)
+    {
+        return mSecondMessages[a] > mSecondMessages[b] || (mSecondMessages[a] == mSecondMessages[b] && a < b);
+    });
+    Print("\nBusiest seconds    Positions  Messages");
+    for (int i = 0; i < Top; i++)
+    {
+        Print("  %-16s %9lld %9lld", qPrintable(FormatTime(mStartTime + Order[i] * 1000)),
+              mSecondPositions[Order[i]], mSecondMessages[Order[i]]);
+    }
+}
@@ -0,0 +1,37 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FAN_OUT_MODEL_H_
+#define FAN_OUT_MODEL_H_
+
+#include "STLib/ClientContainer.h"
+
+// Replays the scenario against a model of the fan-out of STServer: a
+// position reaches every client whose range covers the sender, that is
+// the vis range for controllers and the pilot range for pilots. Text
+// messages go to their receiver if it is online.
+class FanOutModel
+{
+public:
+    // PilotRange in nm
+    FanOutModel(int PilotRange);
+
+    void Run(const ClientContainer &Cont);
+    void Report(int Top) const;
+
+private:
+    int mPilotRange;
+    int mStartTime;
+    qint64 mPositions;
+    qint64 mMessages;
+    qint64 mBytes;
+
+    // per second of the scenario
+    QVector<qint64> mSecondPositions;
+    QVector<qint64> mSecondMessages;
+    QVector<qint64> mSecondBytes;
+};
+
+#endif
@@ -0,0 +1,21 @@
+QT += core xml concurrent
+QT -= gui
+
+include(../../common.pri)
+
+INCLUDEPATH += . .. ../..
+
+TARGET = STAnalyze
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++14
+
+HEADERS += *.h
+SOURCES += *.cpp
+
+LIBS    += -L$$BuildRoot/lib -lSTLib -lvatlib -lz
+
+DESTDIR = $$BuildRoot/bin
+
+target.path = $$BuildRoot/dist/bin
+INSTALLS += target
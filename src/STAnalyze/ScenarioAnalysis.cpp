@@ -0,0 +1,421 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdarg>
+#include "ScenarioAnalysis.h"
+
+namespace
+{
+    // heap bookkeeping per time update: malloc headers of the update, the
+    // shared_ptr control block and the QList node, plus the list slot
+    const int TimeUpdateOverhead = 3 * 16 + 24 + 16 + 8;
+
+    // QThread with its event dispatcher, the ClientProcess and the vatlib
+    // session with its socket buffers, resident per client
+    const qint64 ClientOverhead = 64 * 1024;
+    // address space reserved for the stack of every client thread
+    const qint64 ThreadStackSize = 8 * 1024 * 1024;
+
+    struct ClientLoad
+    {
+        pClient Client;
+        QVector<ReplayPacket> Packets;
+        // online from the first to the second second
+        QVector<QPair<int, int>> Sessions;
+        int Events;
+        qint64 Memory;
+        int EndTime;
+    };
+
+    qint64 UpdateMemory(const TimeUpdate *Update)
+    {
+        switch (Update->GetUpdateReason())
+        {
+        case PositionAirplaneReason:
+            return sizeof(AirplanePositionUpdate) + TimeUpdateOverhead;
+        case PositionATCReason:
+            return sizeof(ControllerPositionUpdate) + TimeUpdateOverhead;
+        case TextMsg:
+        {
+            const TextMessageUpdate *Text = static_cast<const TextMessageUpdate *>(Update);
+            return sizeof(TextMessageUpdate) + TimeUpdateOverhead +
+                   2 * (Text->GetMessage().size() + Text->GetReceiver().size()) + 2 * 16;
+        }
+        default:
+            return sizeof(TimeUpdate) + TimeUpdateOverhead;
+        }
+    }
+
+    void AnalyzeClient(ClientLoad &Load)
+    {
+        const Client *client = Load.Client.get();
+        Load.Events = client->GetTimeUpdateContainer()->size();
+        Load.Memory = 0;
+        for (const pTimeUpdate &Update : *client->GetTimeUpdateContainer())
+        {
+            Load.Memory += UpdateMemory(Update.get());
+        }
+        Load.Packets = ReplayClient(*client, Load.EndTime);
+
+        int SessionStart = -1;
+        for (const ReplayPacket &Packet : Load.Packets)
+        {
+            if (Packet.Reason == AddAirplaneReason || Packet.Reason == AddATCReason)
+            {
+                SessionStart = Packet.Time / 1000;
+            }
+            else if (Packet.Reason == RemoveAirplaneReason || Packet.Reason == RemoveATCReason)
+            {
+                Load.Sessions.append(qMakePair(SessionStart, Packet.Time / 1000));
+                SessionStart = -1;
+            }
+        }
+        if (SessionStart >= 0)
+        {
+            Load.Sessions.append(qMakePair(SessionStart, qMax(Load.EndTime, 0) / 1000));
+        }
+    }
+
+    QString FormatDuration(int Msecs)
+    {
+        int Seconds = Msecs / 1000;
+        return QString("%1:%2:%3").arg(Seconds / 3600)
+               .arg((Seconds / 60) % 60, 2, 10, QChar('0'))
+               .arg(Seconds % 60, 2, 10, QChar('0'));
+    }
+
+    QString FormatBytes(qint64 Bytes)
+    {
+        if (Bytes >= 10 * 1024 * 1024)
+        {
+            return QString::number(Bytes / (1024 * 1024)) + " MB";
+        }
+        if (Bytes >= 10 * 1024)
+        {
+            return QString::number(Bytes / 1024) + " kB";
+        }
+        return QString::number(Bytes) + " B";
+    }
+
+    // same layout as the hand written .info files
+    QString InfoField(QString Label, QString Value)
+    {
+        return QString("%1%2\n").arg(Label).arg(Value, 21 - Label.size());
+    }
+}
+
+QVector<ReplayPacket> ReplayClient(const Client &client, int &EndTime)
+{
+    // an event that finds the client offline logs it on and is replayed
+    // once connected, after waiting for its time difference again
+    QVector<ReplayPacket> Packets;
+    bool Controller = client.GetType() == ControllerType;
+    QString Callsign = client.GetCallsign();
+    bool Online = false;
+    int Time = 0;
+    for (const pTimeUpdate &Update : *client.GetTimeUpdateContainer())
+    {
+        Time += Update->GetTimeDiff();
+        UpdateReason Reason = Update->GetUpdateReason();
+        bool Remove = Reason == RemoveAirplaneReason || Reason == RemoveATCReason;
+        if (!Online && !Remove)
+        {
+            Packets.append({qMax(Time, 0), Controller ? AddATCReason : AddAirplaneReason,
+                            LogonPacketSize + Callsign.size(), 0, 0});
+            Online = true;
+            Time += Update->GetTimeDiff();
+        }
+        if (!Online)
+        {
+            continue;
+        }
+        switch (Reason)
+        {
+        case PositionAirplaneReason:
+        {
+            // thinned positions go out in the time to the next event
+            int Bytes = EstimatePacketSize(Callsign, Update.get());
+            Packets.append({qMax(Time, 0), Reason, Bytes, Update.get(), 0});
+            int StepTime = Time;
+            const QVector<int> &Steps = static_cast<const AirplanePositionUpdate *>(Update.get())->GetSteps();
+            for (int Step = 0; Step < Steps.size(); Step++)
+            {
+                StepTime += Steps[Step];
+                Packets.append({qMax(StepTime, 0), Reason, Bytes, Update.get(), Step + 1});
+            }
+            break;
+        }
+        case PositionATCReason:
+        case TextMsg:
+        case RemoveAirplaneReason:
+        case RemoveATCReason:
+            Packets.append({qMax(Time, 0), Reason, EstimatePacketSize(Callsign, Update.get()), Update.get(), 0});
+            Online = !Remove;
+            break;
+        default:
+            break;
+        }
+    }
+    EndTime = Time;
+    return Packets;
+}
+
+void Print(const char *Format, ...)
+{
+    va_list Args;
+    va_start(Args, Format);
+    qDebug() << qPrintable(QString::vasprintf(Format, Args));
+    va_end(Args);
+}
+
+QString FormatTime(int Msecs)
+{
+    return QTime::fromMSecsSinceStartOfDay(((Msecs % 86400000) + 86400000) % 86400000).toString("hh:mm:ss");
+}
+
+ScenarioAnalysis::ScenarioAnalysis()
+    : mStartTime(0), mDuration(0), mClients(0), mAirplanes(0), mControllers(0),
+      mSessions(0), mEvents(0), mEventMemory(0)
+{
+}
+
+void ScenarioAnalysis::Analyze(const ClientContainer &Cont)
+{
+    QVector<ClientLoad> Loads(Cont.size());
+    for (int i = 0; i < Cont.size(); i++)
+    {
+        Loads[i].Client = Cont[i];
+    }
+    QtConcurrent::blockingMap(Loads, AnalyzeClient);
+
+    mStartTime = Cont.GetStartTime();
+    mDuration = 0;
+    mClients = Cont.size();
+    mAirplanes = 0;
+    mControllers = 0;
+    mSessions = 0;
+    mEvents = 0;
+    mEventMemory = 0;
+    for (const ClientLoad &Load : Loads)
+    {
+        mDuration = qMax(mDuration, Load.EndTime);
+        mEvents += Load.Events;
+        mEventMemory += Load.Memory;
+        mSessions += Load.Sessions.size();
+        if (Load.Client->GetType() == ControllerType)
+        {
+            mControllers++;
+        }
+        else
+        {
+            mAirplanes++;
+        }
+    }
+
+    int Seconds = mDuration / 1000 + 1;
+    mPackets.fill(0, Seconds);
+    mTypePackets.fill(QVector<qint64>(Seconds, 0), UpdateReasonCount);
+    mTypeBytes.fill(QVector<qint64>(Seconds, 0), UpdateReasonCount);
+    QVector<int> Diff(Seconds + 1, 0);
+    for (const ClientLoad &Load : Loads)
+    {
+        for (const ReplayPacket &Packet : Load.Packets)
+        {
+            int Second = Packet.Time / 1000;
+            mPackets[Second]++;
+            mTypePackets[Packet.Reason][Second]++;
+            mTypeBytes[Packet.Reason][Second] += Packet.Bytes;
+        }
+        for (const auto &Session : Load.Sessions)
+        {
+            Diff[Session.first]++;
+            Diff[Session.second + 1]--;
+        }
+    }
+    mConcurrent.fill(0, Seconds);
+    int Concurrent = 0;
+    for (int i = 0; i < Seconds; i++)
+    {
+        Concurrent += Diff[i];
+        mConcurrent[i] = Concurrent;
+    }
+}
+
+void ScenarioAnalysis::Report(int Top) const
+{
+    int Seconds = mPackets.size();
+    qint64 TotalPackets = 0;
+    for (qint64 Count : mPackets)
+    {
+        TotalPackets += Count;
+    }
+    int PeakSecond = std::max_element(mConcurrent.begin(), mConcurrent.end()) - mConcurrent.begin();
+    int PeakConcurrent = mConcurrent.isEmpty() ? 0 : mConcurrent[PeakSecond];
+
+    Print("Clients:            %d (%d airplanes, %d controllers)", mClients, mAirplanes, mControllers);
+    Print("Sessions:           %d", mSessions);
+    Print("Events:             %lld", mEvents);
+    Print("Packets:            %lld, avg %.1f/s", TotalPackets, Seconds > 0 ? TotalPackets / double(Seconds) : 0.0);
+    Print("Peak concurrent:    %d at %s", PeakConcurrent,
+           qPrintable(FormatTime(mStartTime + PeakSecond * 1000)));
+
+    // seconds by packets sent in them, in powers of two
+    QVector<int> Histogram;
+    for (qint64 Count : mPackets)
+    {
+        int Bucket = 0;
+        while ((Count >> Bucket) > 0)
+        {
+            Bucket++;
+        }
+        if (Bucket >= Histogram.size())
+        {
+            Histogram.resize(Bucket + 1);
+        }
+        Histogram[Bucket]++;
+    }
+    Print("\nPackets/s          Seconds");
+    for (int i = 0; i < Histogram.size(); i++)
+    {
+        QString Range = i == 0 ? "0" : (i == 1 ? "1" : QString("%1-%2").arg(1 << (i - 1)).arg((1 << i) - 1));
+        Print("  %-16s %7d", qPrintable(Range), Histogram[i]);
+    }
+
+    QVector<int> Order(Seconds);
+    for (int i = 0; i < Seconds; i++)
+    {
+        Order[i] = i;
+    }
+    Top = qMin(Top, Seconds);
+    std::partial_sort(Order.begin(), Order.begin() + Top, Order.end(), [this](int a, int b)
+    {
+        return mPackets[a] > mPackets[b] || (mPackets[a] == mPackets[b] && a < b);
+    });
+    Print("\nBurstiest seconds  Packets  Concurrent");
+    for (int i = 0; i < Top; i++)
+    {
+        Print("  %-16s %7lld %11d", qPrintable(FormatTime(mStartTime + Order[i] * 1000)),
+               mPackets[Order[i]], mConcurrent[Order[i]]);
+    }
+
+    Print("\nPacket type        Packets    avg B/s   peak B/s");
+    qint64 TotalBytes = 0;
+    QVector<qint64> Bytes(Seconds, 0);
+    for (int Type = 0; Type < UpdateReasonCount; Type++)
+    {
+        qint64 Packets = 0;
+        qint64 Sum = 0;
+        qint64 Peak = 0;
+        for (int i = 0; i < Seconds; i++)
+        {
+            Packets += mTypePackets[Type][i];
+            Sum += mTypeBytes[Type][i];
+            Peak = qMax(Peak, mTypeBytes[Type][i]);
+            Bytes[i] += mTypeBytes[Type][i];
+        }
+        if (Packets > 0)
+        {
+            Print("  %-16s %7lld %10.1f %10lld", qPrintable(UpdateReasonToString(static_cast<UpdateReason>(Type))),
+                   Packets, Sum / double(Seconds), Peak);
+        }
+        TotalBytes += Sum;
+    }
+    Print("  %-16s %7lld %10.1f %10lld", "total", TotalPackets,
+           Seconds > 0 ? TotalBytes / double(Seconds) : 0.0,
+           Bytes.isEmpty() ? 0 : *std::max_element(Bytes.begin(), Bytes.end()));
+
+    // STd starts a thread with its own vatlib session for every client up
+    // front and keeps the socket open while the client is logged on
+    Print("\nSTd budget");
+    Print("  Threads:          %d", mClients + 1);
+    Print("  Sockets:          %d", PeakConcurrent);
+    Print("  File descriptors: %d", mClients + PeakConcurrent + 3);
+    Print("  Scenario memory:  %s", qPrintable(FormatBytes(mEventMemory)));
+    Print("  Resident memory:  %s", qPrintable(FormatBytes(mEventMemory + mClients * ClientOverhead)));
+    Print("  Stack reserved:   %s", qPrintable(FormatBytes((mClients + 1) * ThreadStackSize)));
+}
+
+QList<QPair<QString, QString>> ScenarioAnalysis::GetInfoFields() const
+{
+    QList<QPair<QString, QString>> Fields;
+    Fields.append(qMakePair(QString("Start:"), FormatTime(mStartTime)));
+    Fields.append(qMakePair(QString("End:"), FormatTime(mStartTime + mDuration)));
+    Fields.append(qMakePair(QString("Play time:"), FormatDuration(mDuration)));
+    Fields.append(qMakePair(QString("Connections:"), QString::number(mSessions)));
+    return Fields;
+}
+
+QString ScenarioAnalysis::GetInfo() const
+{
+    QString Info;
+    for (const auto &Field : GetInfoFields())
+    {
+        Info += InfoField(Field.first, Field.second);
+    }
+    return Info;
+}
+
+bool ScenarioAnalysis::WriteInfoFile(QString Filename) const
+{
+    // the event name, the description and the date are written by hand
+    QStringList Lines;
+    QFile file(Filename);
+    if (file.exists())
+    {
+        if (!file.open(QFile::ReadOnly | QFile::Text))
+        {
+            qDebug() << "Error: Cannot read file "
+                     << qPrintable(Filename) << ": "
+                     << qPrintable(file.errorString());
+            return false;
+        }
+        Lines = QString::fromLatin1(file.readAll()).split('\n');
+        file.close();
+    }
+    // the hand written files have no line end after the last line
+    bool FinalNewline = Lines.isEmpty() || Lines.last().isEmpty();
+    if (!Lines.isEmpty() && Lines.last().isEmpty())
+    {
+        Lines.removeLast();
+    }
+    for (const auto &Field : GetInfoFields())
+    {
+        QString Line = InfoField(Field.first, Field.second);
+        Line.chop(1);
+        bool Found = false;
+        for (QString &Existing : Lines)
+        {
+            if (Existing.startsWith(Field.first))
+            {
+                Existing = Line;
+                Found = true;
+            }
+        }
+        if (!Found)
+        {
+            Lines.append(Line);
+        }
+    }
+
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+    file.write((Lines.join('\n') + (FinalNewline ? "\n" : "")).toLatin1());
+    file.close();
+    if (file.error())
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+    return true;
+}
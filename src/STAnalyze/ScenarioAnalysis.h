@@ -0,0 +1,70 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SCENARIO_ANALYSIS_H_
+#define SCENARIO_ANALYSIS_H_
+
+#include "STLib/ClientContainer.h"
+#include "STLib/PacketSize.h"
+
+const int UpdateReasonCount = SBInfoReason + 1;
+
+struct ReplayPacket
+{
+    // ms after the start of the scenario
+    int Time;
+    UpdateReason Reason;
+    int Bytes;
+    // 0 for logons
+    const TimeUpdate *Update;
+    // thinned position of the update, 0 for the update itself
+    int Step;
+};
+
+// the packets STd sends for the client in the order it sends them,
+// EndTime is the time of its last event
+QVector<ReplayPacket> ReplayClient(const Client &client, int &EndTime);
+
+// qDebug like the other tools, but with aligned columns
+void Print(const char *Format, ...);
+// time of day of ms since midnight as hh:mm:ss
+QString FormatTime(int Msecs);
+
+// Predicts what a replay of the scenario sends to the server, second by
+// second, without connecting anywhere.
+class ScenarioAnalysis
+{
+public:
+    ScenarioAnalysis();
+
+    void Analyze(const ClientContainer &Cont);
+    void Report(int Top) const;
+
+    QString GetInfo() const;
+    // updates the fields of GetInfo in an existing file, the hand written
+    // lines stay as they are
+    bool WriteInfoFile(QString Filename) const;
+
+private:
+    // label and value of every field of the info
+    QList<QPair<QString, QString>> GetInfoFields() const;
+
+    int mStartTime;
+    int mDuration;
+    int mClients;
+    int mAirplanes;
+    int mControllers;
+    int mSessions;
+    qint64 mEvents;
+    qint64 mEventMemory;
+
+    // per second of the scenario
+    QVector<int> mConcurrent;
+    QVector<qint64> mPackets;
+    QVector<QVector<qint64>> mTypePackets;
+    QVector<QVector<qint64>> mTypeBytes;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QCommandLineParser>
+
+#include "STLib/ClientContainer.h"
+#include "ScenarioAnalysis.h"
+#include "FanOutModel.h"
+
+#define DEFAULT_FILENAME "../Logs/Onlineday_LOWW.xml"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("trafficsim-analyze");
+    QCommandLineParser parser;
+    parser.setApplicationDescription("predicts the load a scenario puts on the server and on STd.");
+    parser.addHelpOption();
+    parser.addOption({{"x", "xml"},
+                      QCoreApplication::translate("main", "Scenario <scenariofile> in xml format"),
+                      QCoreApplication::translate("main", "scenariofile"),
+                      DEFAULT_FILENAME
+                     });
+    parser.addOption({{"t", "top"},
+                      QCoreApplication::translate("main", "List the <count> burstiest seconds"),
+                      QCoreApplication::translate("main", "count"),
+                      "10"
+                     });
+    parser.addOption({{"o", "info"},
+                      QCoreApplication::translate("main", "Write the summary fields to <infofile>"),
+                      QCoreApplication::translate("main", "infofile")
+                     });
+    parser.addOption({{"f", "fanout"},
+                      QCoreApplication::translate("main", "Model the fan-out of the positions on the server")
+                     });
+    parser.addOption({{"r", "range"},
+                      QCoreApplication::translate("main", "Pilots see other pilots within <nm> in the fan-out model"),
+                      QCoreApplication::translate("main", "nm"),
+                      "40"
+                     });
+
+    parser.process(a);
+
+    QString FileName = parser.value("xml");
+    ClientContainer Cont(FileName);
+
+    QElapsedTimer Timer;
+    Timer.start();
+    ScenarioAnalysis Analysis;
+    Analysis.Analyze(Cont);
+    qDebug() << "-- analyzed" << Cont.size() << "clients in" << Timer.elapsed() << "ms";
+
+    Analysis.Report(parser.value("top").toInt());
+
+    if (parser.isSet("fanout"))
+    {
+        Timer.restart();
+        FanOutModel Model(parser.value("range").toInt());
+        Model.Run(Cont);
+        Model.Report(parser.value("top").toInt());
+        qDebug() << "-- modelled the fan-out in" << Timer.elapsed() << "ms";
+    }
+    qDebug() << "";
+    qDebug() << qPrintable(Analysis.GetInfo().trimmed());
+
+    if (parser.isSet("info"))
+    {
+        if (!Analysis.WriteInfoFile(parser.value("info")))
+        {
+            return 1;
+        }
+        qDebug() << "-- written info-File: " << parser.value("info");
+    }
+    return 0;
+}
@@ -13,7 +13,7 @@ CONFIG += c++14
 SOURCES += *.cpp
 HEADERS += *.h
 
-LIBS    += -L$$BuildRoot/lib -lSTLib -lvatlib
+LIBS    += -L$$BuildRoot/lib -lSTLib -lvatlib -lz
 
 DESTDIR = $$BuildRoot/bin
 
@@ -3,7 +3,11 @@
  *  License, v. 2.0. If a copy of the MPL was not distributed with this
  *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-#include "FSInnReader.h"
+#include <QCommandLineParser>
+
+#include "STLib/FSInnReader.h"
+#include "STLib/LogMerger.h"
+#include "STLib/TrajectoryThinner.h"
 
 std::string removeExtension(const std::string filename)
 {
@@ -15,26 +19,176 @@ std::string removeExtension(const std::string filename)
     return filename.substr(0, lastdot);
 }
 
+// filters, thins and writes a container read from logs
+void ExportContainer(ClientContainer &cont, QString FileName, const GeoFilter &Filter,
+                     const TrajectoryThinner *Thinner, bool Compact)
+{
+    if (Filter.IsSet())
+    {
+        int Total = cont.size();
+        cont.Filter(Filter);
+        qDebug() << "-- kept" << cont.size() << "of" << Total << "clients";
+    }
+    if (Thinner != 0)
+    {
+        cont.MakeTimesRelative();
+        int Removed = 0;
+        for (pClient &client : cont)
+        {
+            if (client->GetType() == AirplaneType)
+            {
+                Removed += Thinner->Thin(*client);
+            }
+        }
+        qDebug() << "-- thinned out" << Removed << "positions";
+    }
+    cont.WriteToXMLFile(FileName, Compact);
+    qDebug() << "-- exported to xml-File: " << FileName;
+}
+
 int main(int argc, char *argv[])
 {
-    if (argc < 2)
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("trafficsim-export");
+    QCommandLineParser parser;
+    parser.setApplicationDescription("converts FSInn logs into scenarios, xml scenarios are only filtered.\n"
+                                     "With --merge all logs are one event recorded at several places.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", QCoreApplication::translate("main", "FSInn log-files or xml scenarios"),
+                                 "<LOG-FILE> { <LOG-FILE> }");
+    parser.addOption({{"b", "box"},
+                      QCoreApplication::translate("main", "Keep only clients that enter the box <lat1,long1,lat2,long2>, west before east"),
+                      QCoreApplication::translate("main", "lat1,long1,lat2,long2")
+                     });
+    parser.addOption({{"r", "radius"},
+                      QCoreApplication::translate("main", "Keep only clients that come within <nm> of <lat,long>"),
+                      QCoreApplication::translate("main", "lat,long,nm")
+                     });
+    parser.addOption({{"t", "thin"},
+                      QCoreApplication::translate("main", "Leave out airplane positions the replay can recreate")
+                     });
+    parser.addOption({"thin-distance",
+                      QCoreApplication::translate("main", "Largest position error of a thinned track in <nm>, default 0.05"),
+                      QCoreApplication::translate("main", "nm"), "0.05"
+                     });
+    parser.addOption({"thin-heading",
+                      QCoreApplication::translate("main", "Largest heading, pitch and bank error of a thinned track in <deg>, default 2"),
+                      QCoreApplication::translate("main", "deg"), "2"
+                     });
+    parser.addOption({{"c", "compact"},
+                      QCoreApplication::translate("main", "Store the airplane positions as delta coded columns")
+                     });
+    parser.addOption({{"m", "merge"},
+                      QCoreApplication::translate("main", "Merge the log-files by time into the one scenario <file>"),
+                      QCoreApplication::translate("main", "file")
+                     });
+    parser.addOption({{"z", "gzip"},
+                      QCoreApplication::translate("main", "Write gzip compressed scenarios, compressed inputs always give compressed outputs")
+                     });
+
+    parser.process(a);
+
+    const QStringList Files = parser.positionalArguments();
+    if (Files.isEmpty())
     {
         qDebug() << "You have to add the filename of the log-file!";
-        qDebug() << "usage:";
-        qDebug() << "      " << argv[0] << " <LOG-FILE> { <LOG-FILE> }";
+        parser.showHelp(1);
+    }
+
+    if (parser.isSet("box") && parser.isSet("radius"))
+    {
+        qDebug() << "Error: a filter is either a box or a radius";
+        return 1;
+    }
+    GeoFilter Filter;
+    if (parser.isSet("box") && !Filter.ParseBox(parser.value("box")))
+    {
+        qDebug() << "Error: invalid box " << qPrintable(parser.value("box"));
+        return 1;
+    }
+    if (parser.isSet("radius") && !Filter.ParseRadius(parser.value("radius")))
+    {
+        qDebug() << "Error: invalid radius " << qPrintable(parser.value("radius"));
+        return 1;
+    }
+
+    bool DistanceOk = false;
+    bool HeadingOk = false;
+    TrajectoryThinner Thinner(parser.value("thin-distance").toDouble(&DistanceOk),
+                              parser.value("thin-heading").toDouble(&HeadingOk));
+    if (!DistanceOk || !HeadingOk)
+    {
+        qDebug() << "Error: invalid thinning bounds";
         return 1;
     }
-    for (int i = 1; i < argc; i++)
+    bool Thin = parser.isSet("thin");
+    bool Compact = parser.isSet("compact");
+    bool Gzip = parser.isSet("gzip");
+
+    if (parser.isSet("merge"))
+    {
+        QString Output = parser.value("merge");
+        if (Gzip && !GzipFile::IsCompressedName(Output))
+        {
+            Output += ".gz";
+        }
+        qDebug() << "---------------------------------------------------------";
+        qDebug() << "-- Merging" << Files.size() << "log-files";
+        LogMerger Merger(Files);
+        ClientContainer cont;
+        if (!Merger.Merge(cont))
+        {
+            return 1;
+        }
+        qDebug() << "-- left out" << Merger.GetDuplicates() << "events seen by more than one log";
+        ExportContainer(cont, Output, Filter, Thin ? &Thinner : 0, Compact);
+        qDebug() << "---------------------------------------------------------";
+        return 0;
+    }
+
+    for (QString FileName : Files)
     {
         qDebug() << "---------------------------------------------------------";
-        qDebug() << "-- Next Log-File: " << argv[i];
-        QString FileName = argv[i];
+        qDebug() << "-- Next Log-File: " << qPrintable(FileName);
+        // compressed files are read and written as a stream, the name
+        // without .gz tells what is inside
+        bool Compressed = GzipFile::IsCompressedName(FileName);
+        QString BaseName = Compressed ? FileName.left(FileName.size() - 3) : FileName;
+        QString Suffix = Compressed || Gzip ? ".xml.gz" : ".xml";
+        if (BaseName.endsWith(".xml", Qt::CaseInsensitive))
+        {
+            // scenarios are filtered client by client into a new file
+            if (!Filter.IsSet() && !Thin && !Compact && (Compressed || !Gzip))
+            {
+                qDebug() << "-- already a scenario, nothing to do";
+                continue;
+            }
+            QString Output = QString::fromStdString(removeExtension(BaseName.toStdString())) +
+                             (Filter.IsSet() ? ".area" : "") + (Thin ? ".thin" : "") + (Compact ? ".compact" : "") +
+                             Suffix;
+            int Kept = 0;
+            int Total = 0;
+            int Removed = 0;
+            if (!ClientContainer::FilterXMLFile(FileName, Output, Filter, Thin ? &Thinner : 0, Compact, &Kept, &Total,
+                                                &Removed))
+            {
+                return 1;
+            }
+            qDebug() << "-- kept" << Kept << "of" << Total << "clients";
+            if (Thin)
+            {
+                qDebug() << "-- thinned out" << Removed << "positions";
+            }
+            qDebug() << "-- exported to xml-File: " << Output;
+            qDebug() << "---------------------------------------------------------";
+            qDebug() << "";
+            continue;
+        }
         FSInnReader Reader(FileName);
         ClientContainer cont;
         Reader.ReadFile(cont);
-        FileName = QString::fromStdString(removeExtension(FileName.toStdString()) + ".xml");
-        cont.WriteToXMLFile(FileName);
-        qDebug() << "-- exported to xml-File: " << FileName;
+        FileName = QString::fromStdString(removeExtension(BaseName.toStdString())) + Suffix;
+        ExportContainer(cont, FileName, Filter, Thin ? &Thinner : 0, Compact);
         qDebug() << "---------------------------------------------------------";
         qDebug() << "";
     }
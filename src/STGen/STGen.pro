@@ -0,0 +1,20 @@
+QT += core xml concurrent
+QT -= gui
+
+include(../../common.pri)
+
+INCLUDEPATH += . .. ../..
+
+TARGET = STGen
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++14
+
+SOURCES += *.cpp
+
+LIBS    += -L$$BuildRoot/lib -lSTLib -lvatlib -lz
+
+DESTDIR = $$BuildRoot/bin
+
+target.path = $$BuildRoot/dist/bin
+INSTALLS += target
@@ -0,0 +1,145 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QCommandLineParser>
+
+#include "STLib/TrafficGenerator.h"
+#include "STLib/LoadShape.h"
+
+#define DEFAULT_FILENAME "synthetic.xml"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("trafficsim-generator");
+    QCommandLineParser parser;
+    parser.setApplicationDescription("generates a synthetic scenario without a recorded log.");
+    parser.addHelpOption();
+    parser.addOption({{"o", "output"},
+                      QCoreApplication::translate("main", "Write the scenario to <scenariofile>"),
+                      QCoreApplication::translate("main", "scenariofile"),
+                      DEFAULT_FILENAME
+                     });
+    parser.addOption({{"s", "seed"},
+                      QCoreApplication::translate("main", "Random <seed>, the same seed gives the same scenario"),
+                      QCoreApplication::translate("main", "seed"),
+                      "1"
+                     });
+    parser.addOption({{"f", "flights"},
+                      QCoreApplication::translate("main", "Number of <flights>"),
+                      QCoreApplication::translate("main", "flights"),
+                      "100"
+                     });
+    parser.addOption({{"c", "controllers"},
+                      QCoreApplication::translate("main", "Number of <controllers>"),
+                      QCoreApplication::translate("main", "controllers"),
+                      "10"
+                     });
+    parser.addOption({{"d", "duration"},
+                      QCoreApplication::translate("main", "Length of the scenario in <minutes>"),
+                      QCoreApplication::translate("main", "minutes"),
+                      "120"
+                     });
+    parser.addOption({{"t", "start"},
+                      QCoreApplication::translate("main", "Scenario start <time> as hh:mm"),
+                      QCoreApplication::translate("main", "time"),
+                      "12:00"
+                     });
+    parser.addOption({{"a", "airports"},
+                      QCoreApplication::translate("main", "Airports from <file>, one \"ICAO Lat Long Elevation\" per line"),
+                      QCoreApplication::translate("main", "file")
+                     });
+    parser.addOption({{"e", "extract"},
+                      QCoreApplication::translate("main", "Extract the load shape of <scenariofile> into the output file and quit"),
+                      QCoreApplication::translate("main", "scenariofile")
+                     });
+    parser.addOption({{"l", "shape"},
+                      QCoreApplication::translate("main", "Shape the traffic like the extracted load shape in <file>"),
+                      QCoreApplication::translate("main", "file")
+                     });
+    parser.addOption({{"x", "scale"},
+                      QCoreApplication::translate("main", "Scale the clients of the load shape by <factor>"),
+                      QCoreApplication::translate("main", "factor"),
+                      "1"
+                     });
+
+    parser.process(a);
+
+    if (parser.isSet("extract"))
+    {
+        ClientContainer Cont(parser.value("extract"));
+        LoadShape Shape;
+        Shape.Extract(Cont);
+        qDebug() << "Minutes:           " << Shape.GetMinutes().size();
+        qDebug() << "Pilot logons:      " << Shape.GetTotalPilotLogons();
+        qDebug() << "Peak pilots:       " << Shape.GetPeakPilots();
+        qDebug() << "Peak controllers:  " << Shape.GetPeakControllers();
+        if (!Shape.WriteToXMLFile(parser.value("output")))
+        {
+            return 1;
+        }
+        qDebug() << "-- exported to xml-File: " << parser.value("output");
+        return 0;
+    }
+
+    TrafficGenerator Generator(parser.value("seed").toUInt());
+    if (parser.isSet("airports") && !Generator.LoadAirports(parser.value("airports")))
+    {
+        return 1;
+    }
+
+    QTime Start = QTime::fromString(parser.value("start"), "hh:mm");
+    int StartTime = Start.isValid() ? Start.msecsSinceStartOfDay() : 0;
+    int Duration = parser.value("duration").toInt() * 60000;
+    int Flights = parser.value("flights").toInt();
+    int Controllers = parser.value("controllers").toInt();
+
+    // the load shape gives the defaults, explicit options still win
+    LoadShape Shape;
+    if (parser.isSet("shape"))
+    {
+        if (!Shape.ReadFromXMLFile(parser.value("shape")))
+        {
+            return 1;
+        }
+        double Scale = parser.value("scale").toDouble();
+        if (!parser.isSet("start"))
+        {
+            StartTime = Shape.GetStartTime();
+        }
+        if (!parser.isSet("duration"))
+        {
+            Duration = Shape.GetDuration();
+        }
+        if (!parser.isSet("flights"))
+        {
+            Flights = qRound(Shape.GetTotalPilotLogons() * Scale);
+        }
+        if (!parser.isSet("controllers"))
+        {
+            Controllers = qRound(Shape.GetPeakControllers() * Scale);
+        }
+        Generator.SetLoadShape(&Shape);
+    }
+
+    qDebug() << "Airports:          " << Generator.GetAirportCount();
+    qDebug() << "Flights:           " << Flights;
+    qDebug() << "Controllers:       " << Controllers;
+    qDebug() << "Seed:              " << parser.value("seed").toUInt();
+
+    QElapsedTimer Timer;
+    Timer.start();
+    ClientContainer Cont;
+    Generator.Generate(Cont, Flights, Controllers, StartTime, Duration);
+    qDebug() << "-- generated" << Cont.size() << "clients in" << Timer.elapsed() << "ms";
+
+    QString FileName = parser.value("output");
+    if (!Cont.WriteToXMLFile(FileName))
+    {
+        return 1;
+    }
+    qDebug() << "-- exported to xml-File: " << FileName;
+    return 0;
+}
@@ -5,6 +5,7 @@
 
 #include "Client.h"
 #include "exporter.h"
+#include "PositionColumns.h"
 #include <iterator>
 
 Client::Client(QString Callsign, eClientType Type)
@@ -53,6 +54,19 @@ void Client::ReadInnerElements(QXmlStreamReader *xmlReader)
         {
             AddTimeUpdate(pTimeUpdate(new AirplanePositionUpdate(xmlReader)));
         }
+        else if (xmlReader->isStartElement() && xmlReader->name() == "AirplanePositions")
+        {
+            TimeUpdateContainer Positions;
+            QByteArray Data = QByteArray::fromBase64(xmlReader->attributes().value("Data").toString().toLatin1());
+            if (!DecodePositionColumns(Data, xmlReader->attributes().value("Count").toString().toInt(), Positions))
+            {
+                qDebug() << "Error: damaged positions of " << qPrintable(mCallsign);
+            }
+            for (const pTimeUpdate &Update : Positions)
+            {
+                AddTimeUpdate(Update);
+            }
+        }
         else if (xmlReader->isStartElement() && xmlReader->name() == "ControllerPosition")
         {
             AddTimeUpdate(pTimeUpdate(new ControllerPositionUpdate(xmlReader)));
@@ -63,6 +77,12 @@ void Client::ReadInnerElements(QXmlStreamReader *xmlReader)
         }
     }
 
+    LinkSegments();
+    InitOnlineState();
+}
+
+void Client::InitOnlineState()
+{
     if (mTimeUpdate.begin() != mTimeUpdate.end() && (*mTimeUpdate.begin())->GetUpdateReason() != AddAirplaneReason)
     {
         mIsOnline = true;
@@ -103,7 +123,58 @@ bool Client::IsOnline() const
     return mIsOnline;
 }
 
-void Client::SerializeClient(QXmlStreamWriter *xmlWriter)
+void Client::SerializeClient(QXmlStreamWriter *xmlWriter, bool Compact)
+{
+    DropTrailingUpdates();
+
+    xmlWriter->writeAttribute("Callsign", mCallsign);
+    xmlWriter->writeAttribute("Rating", QString::number(mRating));
+
+    int i = 0;
+    while (i < mTimeUpdate.size())
+    {
+        int End = i;
+        while (Compact && End < mTimeUpdate.size() && IsColumnPosition(mTimeUpdate[End].get()))
+        {
+            End++;
+        }
+        if (End - i < MinColumnRun)
+        {
+            mTimeUpdate[i]->Serialize(xmlWriter);
+            i++;
+            continue;
+        }
+        QVector<const AirplanePositionUpdate *> Run;
+        Run.reserve(End - i);
+        for (; i < End; i++)
+        {
+            Run.append(static_cast<const AirplanePositionUpdate *>(mTimeUpdate[i].get()));
+        }
+        xmlWriter->writeStartElement("AirplanePositions");
+        xmlWriter->writeAttribute("Count", QString::number(Run.size()));
+        xmlWriter->writeAttribute("Data", QString::fromLatin1(EncodePositionColumns(Run).toBase64()));
+        xmlWriter->writeEndElement();
+    }
+}
+
+void Client::PrepareForReplay()
+{
+    DropTrailingUpdates();
+    for (auto &timeUpdate : mTimeUpdate)
+    {
+        if (timeUpdate->GetUpdateReason() == PositionAirplaneReason)
+        {
+            static_cast<AirplanePositionUpdate *>(timeUpdate.get())->RoundAsSerialized();
+        }
+        else if (timeUpdate->GetUpdateReason() == PositionATCReason)
+        {
+            static_cast<ControllerPositionUpdate *>(timeUpdate.get())->RoundAsSerialized();
+        }
+    }
+    InitOnlineState();
+}
+
+void Client::DropTrailingUpdates()
 {
     // https://dev.vatsim-germany.org/issues/340
     // Delete all TimeUpdates after the last position update, because
@@ -127,14 +198,6 @@ void Client::SerializeClient(QXmlStreamWriter *xmlWriter)
         // erasing from there.
         mTimeUpdate.erase(lastPositionUpdate.base(), mTimeUpdate.end());
     }
-
-    xmlWriter->writeAttribute("Callsign", mCallsign);
-    xmlWriter->writeAttribute("Rating", QString::number(mRating));
-
-    for (auto &timeUpdate : mTimeUpdate)
-    {
-        timeUpdate->Serialize(xmlWriter);
-    }
 }
 
 void Client::AddTimeUpdate(pTimeUpdate NextUpdate)
@@ -158,6 +221,37 @@ TimeUpdateContainer *Client::GetTimeUpdateContainer()
     return &mTimeUpdate;
 }
 
+const TimeUpdateContainer *Client::GetTimeUpdateContainer() const
+{
+    return &mTimeUpdate;
+}
+
+int Client::GetDuration() const
+{
+    int Duration = 0;
+    for (const pTimeUpdate &Update : mTimeUpdate)
+    {
+        Duration += Update->GetTimeDiff();
+    }
+    return Duration;
+}
+
+void Client::LinkSegments()
+{
+    for (int i = 0; i + 1 < mTimeUpdate.size(); i++)
+    {
+        if (mTimeUpdate[i]->GetUpdateReason() == PositionAirplaneReason &&
+            mTimeUpdate[i + 1]->GetUpdateReason() == PositionAirplaneReason)
+        {
+            AirplanePositionUpdate *Pos = static_cast<AirplanePositionUpdate *>(mTimeUpdate[i].get());
+            if (!Pos->GetSteps().isEmpty() && !Pos->IsHold())
+            {
+                Pos->SetSegmentEnd(static_cast<AirplanePositionUpdate *>(mTimeUpdate[i + 1].get()));
+            }
+        }
+    }
+}
+
 
 Airplane::Airplane(QString Callsign)
     : Client(Callsign, AirplaneType)
@@ -197,9 +291,14 @@ Airplane::Airplane(QXmlStreamReader *xmlReader)
     ReadInnerElements(xmlReader);
 }
 
-void Airplane::Serialize(QXmlStreamWriter *xmlWriter)
+bool Airplane::IsExportable() const
+{
+    return mAircraftClientType != AircraftTypeNotSet;
+}
+
+void Airplane::Serialize(QXmlStreamWriter *xmlWriter, bool Compact)
 {
-    if (mAircraftClientType == AircraftTypeNotSet)
+    if (!IsExportable())
     {
         return;
     }
@@ -220,7 +319,7 @@ void Airplane::Serialize(QXmlStreamWriter *xmlWriter)
         xmlWriter->writeAttribute("Airline", mAircraftAirline);
         xmlWriter->writeAttribute("Livery", mAircraftLivery);
     }
-    this->SerializeClient(xmlWriter);
+    this->SerializeClient(xmlWriter, Compact);
     xmlWriter->writeEndElement();
 }
 
@@ -341,12 +440,17 @@ Controller::Controller(QXmlStreamReader *xmlReader)
     ReadInnerElements(xmlReader);
 }
 
-void Controller::Serialize(QXmlStreamWriter *xmlWriter)
+bool Controller::IsExportable() const
+{
+    return CountPositionUpdates() > 0;
+}
+
+void Controller::Serialize(QXmlStreamWriter *xmlWriter, bool Compact)
 {
-    if (CountPositionUpdates() > 0)
+    if (IsExportable())
     {
         xmlWriter->writeStartElement("Controller");
-        this->SerializeClient(xmlWriter);
+        this->SerializeClient(xmlWriter, Compact);
         xmlWriter->writeEndElement();
     }
 }
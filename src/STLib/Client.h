@@ -31,13 +31,27 @@ public:
     void SetOffline();
     bool IsOnline() const;
 
-    virtual void Serialize(QXmlStreamWriter *xmlWriter) = 0;
+    // Compact writes runs of positions as AirplanePositions columns
+    virtual void Serialize(QXmlStreamWriter *xmlWriter, bool Compact) = 0;
+    // clients without it are left out of a scenario
+    virtual bool IsExportable() const = 0;
+    // brings a client read from a log into the state writing and reading
+    // it as a scenario would give, the times must be relative already
+    void PrepareForReplay();
 
     void AddTimeUpdate(pTimeUpdate NextUpdate);
+    // points thinned positions to the position that ends their segment
+    void LinkSegments();
     TimeUpdateContainer *GetTimeUpdateContainer();
+    const TimeUpdateContainer *GetTimeUpdateContainer() const;
+    // time from the start of the scenario to the last update, the times
+    // must be relative
+    int GetDuration() const;
 
 protected:
-    void SerializeClient(QXmlStreamWriter *xmlWriter);
+    void SerializeClient(QXmlStreamWriter *xmlWriter, bool Compact);
+    void DropTrailingUpdates();
+    void InitOnlineState();
     TimeUpdateContainer mTimeUpdate;
     QString mCallsign;
     int mRating;
@@ -63,7 +77,8 @@ public:
     Airplane(QString Callsign);
     Airplane(QXmlStreamReader *xmlReader);
 
-    virtual void Serialize(QXmlStreamWriter *xmlWriter);
+    virtual void Serialize(QXmlStreamWriter *xmlWriter, bool Compact);
+    virtual bool IsExportable() const;
     void SetAirplaneInfo(QString Line);
     bool IsAirplaneInfoSet() const;
 
@@ -102,7 +117,8 @@ public:
     Controller(QString Callsign);
     Controller(QXmlStreamReader *xmlReader);
 
-    virtual void Serialize(QXmlStreamWriter *xmlWriter);
+    virtual void Serialize(QXmlStreamWriter *xmlWriter, bool Compact);
+    virtual bool IsExportable() const;
 
     VatAtcConnection GetConnectionInfo() const;
 private:
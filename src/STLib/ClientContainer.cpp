@@ -4,14 +4,30 @@
  *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "ClientContainer.h"
+#include "GzipFile.h"
+#include "PositionIndex.h"
+#include "TrajectoryThinner.h"
 
 ClientContainer::ClientContainer()
+    : mRelativeTimes(false), mIndexed(0)
 {
 }
 
 ClientContainer::ClientContainer(QString Filename)
+    : mRelativeTimes(true), mIndexed(0)
 {
-    QFile file(Filename);
+    ReadFromXMLFile(Filename, GeoFilter());
+}
+
+ClientContainer::ClientContainer(QString Filename, const GeoFilter &Filter)
+    : mRelativeTimes(true), mIndexed(0)
+{
+    ReadFromXMLFile(Filename, Filter);
+}
+
+void ClientContainer::ReadFromXMLFile(QString Filename, const GeoFilter &Filter)
+{
+    GzipFile file(Filename);
     if (!file.open(QFile::ReadOnly | QFile::Text))
     {
         qDebug() << "Error: Cannot read file "
@@ -24,19 +40,31 @@ ClientContainer::ClientContainer(QString Filename)
     while (!xmlReader.atEnd())
     {
         xmlReader.readNext();
+        pClient client;
         if (xmlReader.isStartElement() && xmlReader.name() == "ClientContainer")
         {
             mStartTime = xmlReader.attributes().value("StartTime").toString().toInt();
         }
         else if (xmlReader.isStartElement() && xmlReader.name() == "Airplane")
         {
-            this->append(pClient(new Airplane(&xmlReader)));
+            client = pClient(new Airplane(&xmlReader));
         }
         else if (xmlReader.isStartElement() && xmlReader.name() == "Controller")
         {
-            this->append(pClient(new Controller(&xmlReader)));
+            client = pClient(new Controller(&xmlReader));
+        }
+        if (client != 0 && Filter.Matches(*client))
+        {
+            this->append(client);
         }
     }
+    if (file.HasError())
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return;
+    }
     if (xmlReader.hasError())
     {
         qDebug() << qPrintable(xmlReader.errorString());
@@ -47,33 +75,51 @@ ClientContainer::ClientContainer(QString Filename)
 
 pClient ClientContainer::SearchClient(QString Callsign, eClientType Type)
 {
-    for (auto iter = this->begin(); iter != this->end(); ++iter)
+    // clients appended from outside are indexed on the next search, the
+    // index starts over if clients were taken out
+    if (mIndexed > this->size())
+    {
+        mIndex.clear();
+        mIndexed = 0;
+    }
+    for (; mIndexed < this->size(); mIndexed++)
     {
-        if ((*iter)->GetCallsign() == Callsign && (*iter)->GetType() == Type)
+        const pClient &client = this->at(mIndexed);
+        auto Key = qMakePair(static_cast<int>(client->GetType()), client->GetCallsign());
+        if (!mIndex.contains(Key))
         {
-            return (*iter);
+            mIndex.insert(Key, client);
         }
     }
+
+    pClient client = mIndex.value(qMakePair(static_cast<int>(Type), Callsign));
+    if (client != 0)
+    {
+        return client;
+    }
     if (Type == AirplaneType)
     {
-        this->append(pClient(new Airplane(Callsign)));
+        client = pClient(new Airplane(Callsign));
     }
     else if (Type == ControllerType)
     {
-        this->append(pClient(new Controller(Callsign)));
+        client = pClient(new Controller(Callsign));
     }
     else
     {
         return pClient(0);
     }
-    return this->SearchClient(Callsign, Type);
+    this->append(client);
+    mIndex.insert(qMakePair(static_cast<int>(Type), Callsign), client);
+    mIndexed++;
+    return client;
 }
 
-bool ClientContainer::WriteToXMLFile(QString Filename)
+bool ClientContainer::WriteToXMLFile(QString Filename, bool Compact)
 {
-    CalculateTimes();
+    MakeTimesRelative();
 
-    QFile file(Filename);
+    GzipFile file(Filename);
     if (!file.open(QFile::WriteOnly | QFile::Text))
     {
         qDebug() << "Error: Cannot write file "
@@ -90,7 +136,7 @@ bool ClientContainer::WriteToXMLFile(QString Filename)
 
     for (auto iter = this->cbegin(); iter != this->end(); iter++)
     {
-        (*iter)->Serialize(&xmlWriter);
+        (*iter)->Serialize(&xmlWriter, Compact);
     }
 
     xmlWriter.writeEndElement();
@@ -101,7 +147,7 @@ bool ClientContainer::WriteToXMLFile(QString Filename)
         return false;
     }
     file.close();
-    if (file.error())
+    if (file.HasError())
     {
         qDebug() << "Error: Cannot write file "
                  << qPrintable(Filename) << ": "
@@ -111,6 +157,122 @@ bool ClientContainer::WriteToXMLFile(QString Filename)
     return true;
 }
 
+void ClientContainer::Filter(const GeoFilter &Filter)
+{
+    if (!Filter.IsSet())
+    {
+        return;
+    }
+    PositionIndex Index;
+    Index.Build(*this);
+    QVector<int> Keep = Index.Query(Filter);
+    ClientContainer Kept;
+    for (int i : Keep)
+    {
+        Kept.append(this->at(i));
+    }
+    Kept.mStartTime = mStartTime;
+    Kept.mRelativeTimes = mRelativeTimes;
+    *this = Kept;
+}
+
+bool ClientContainer::FilterXMLFile(QString Input, QString Output, const GeoFilter &Filter,
+                                    const TrajectoryThinner *Thinner, bool Compact, int *Kept, int *Total,
+                                    int *Removed)
+{
+    GzipFile inFile(Input);
+    if (!inFile.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(Input) << ": "
+                 << qPrintable(inFile.errorString());
+        return false;
+    }
+    GzipFile outFile(Output);
+    if (!outFile.open(QFile::WriteOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Output) << ": "
+                 << qPrintable(outFile.errorString());
+        return false;
+    }
+
+    // the time differences are copied as they are, so the kept clients
+    // replay like in the input
+    QXmlStreamReader xmlReader(&inFile);
+    QXmlStreamWriter xmlWriter(&outFile);
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.writeStartDocument();
+    int KeptClients = 0;
+    int TotalClients = 0;
+    int RemovedPositions = 0;
+    while (!xmlReader.atEnd())
+    {
+        xmlReader.readNext();
+        pClient client;
+        if (xmlReader.isStartElement() && xmlReader.name() == "ClientContainer")
+        {
+            xmlWriter.writeStartElement("ClientContainer");
+            xmlWriter.writeAttribute("StartTime", xmlReader.attributes().value("StartTime").toString());
+        }
+        else if (xmlReader.isStartElement() && xmlReader.name() == "Airplane")
+        {
+            client = pClient(new Airplane(&xmlReader));
+        }
+        else if (xmlReader.isStartElement() && xmlReader.name() == "Controller")
+        {
+            client = pClient(new Controller(&xmlReader));
+        }
+        if (client != 0)
+        {
+            TotalClients++;
+            if (Filter.Matches(*client))
+            {
+                if (Thinner != 0 && client->GetType() == AirplaneType)
+                {
+                    RemovedPositions += Thinner->Thin(*client);
+                }
+                client->Serialize(&xmlWriter, Compact);
+                KeptClients++;
+            }
+        }
+    }
+    xmlWriter.writeEndDocument();
+    if (Kept != 0)
+    {
+        *Kept = KeptClients;
+    }
+    if (Total != 0)
+    {
+        *Total = TotalClients;
+    }
+    if (Removed != 0)
+    {
+        *Removed = RemovedPositions;
+    }
+    if (inFile.HasError())
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(Input) << ": "
+                 << qPrintable(inFile.errorString());
+        return false;
+    }
+    if (xmlReader.hasError())
+    {
+        qDebug() << qPrintable(xmlReader.errorString());
+        return false;
+    }
+    outFile.close();
+    if (xmlWriter.hasError() || outFile.HasError())
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Output) << ": "
+                 << qPrintable(outFile.errorString());
+        return false;
+    }
+    return true;
+}
+
 void ClientContainer::SetStartTime(int StartTime)
 {
     mStartTime = StartTime;
@@ -121,6 +283,32 @@ int ClientContainer::GetStartTime() const
     return mStartTime;
 }
 
+void ClientContainer::MakeTimesRelative()
+{
+    if (!mRelativeTimes)
+    {
+        CalculateTimes();
+        mRelativeTimes = true;
+    }
+}
+
+void ClientContainer::PrepareForReplay()
+{
+    MakeTimesRelative();
+    ClientContainer Kept;
+    for (const pClient &client : *this)
+    {
+        if (client->IsExportable())
+        {
+            client->PrepareForReplay();
+            Kept.append(client);
+        }
+    }
+    Kept.mStartTime = mStartTime;
+    Kept.mRelativeTimes = mRelativeTimes;
+    *this = Kept;
+}
+
 void ClientContainer::CalculateTimes()
 {
     for (auto ClientInter = this->begin(); ClientInter != this->end(); ++ClientInter)
@@ -6,24 +6,53 @@
 #ifndef CLIENT_CONTAINER_H_
 #define CLIENT_CONTAINER_H_
 
+#include <QHash>
 #include "Client.h"
+#include "GeoFilter.h"
+
+class TrajectoryThinner;
 
 class ClientContainer : public QList<pClient>
 {
 public:
     ClientContainer();
     ClientContainer(QString Filename);
+    // reads only the clients that match the filter, the others are
+    // dropped as soon as they are parsed
+    ClientContainer(QString Filename, const GeoFilter &Filter);
 
+    // creates the client if there is none yet, NotDefinedType only finds
     pClient SearchClient(QString Callsign, eClientType Type);
-    bool WriteToXMLFile(QString Filename);
+    // Compact stores the airplane positions as delta coded columns
+    bool WriteToXMLFile(QString Filename, bool Compact = false);
+
+    // drops the clients that do not match the filter
+    void Filter(const GeoFilter &Filter);
+    // copies the clients of a scenario that match the filter, one client
+    // at a time without loading the whole scenario, the airplanes are
+    // thinned on the way if a thinner is given
+    static bool FilterXMLFile(QString Input, QString Output, const GeoFilter &Filter,
+                              const TrajectoryThinner *Thinner = 0, bool Compact = false, int *Kept = 0,
+                              int *Total = 0, int *Removed = 0);
 
     void SetStartTime(int StartTime);
     int GetStartTime() const;
 
+    // a container built from a log holds absolute times, a scenario the
+    // time to the previous event of the client
+    void MakeTimesRelative();
+    // replays a container read from a log exactly like its scenario
+    void PrepareForReplay();
+
 private:
+    void ReadFromXMLFile(QString Filename, const GeoFilter &Filter);
     void CalculateTimes();
 
     int mStartTime;
+    bool mRelativeTimes;
+    // callsign and type to client, covers the first mIndexed clients
+    QHash<QPair<int, QString>, pClient> mIndex;
+    int mIndexed;
 };
 
 #endif
@@ -0,0 +1,112 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "ClientView.h"
+
+ClientView::ClientView(pClient client)
+    : mClient(client), mCopyCallsign(client->GetCallsign()), mCallsign(mCopyCallsign), mLatOffset(0.0), mLongOffset(0.0), mTimeShift(0)
+{
+}
+
+ClientView::ClientView(pClient client, QString Suffix, double LatOffset, double LongOffset, int TimeShift,
+                       pCallsignMap Callsigns)
+    : mClient(client), mCopyCallsign(client->GetCallsign() + Suffix), mCallsign(mCopyCallsign), mCallsigns(Callsigns),
+      mLatOffset(LatOffset), mLongOffset(LongOffset), mTimeShift(TimeShift)
+{
+}
+
+pClient ClientView::GetClient() const
+{
+    return mClient;
+}
+
+QString ClientView::GetCallsign() const
+{
+    return mCallsign;
+}
+
+eClientType ClientView::GetType() const
+{
+    return mClient->GetType();
+}
+
+int ClientView::GetTimeShift() const
+{
+    return mTimeShift;
+}
+
+void ClientView::SetRotation(int Index)
+{
+    mRotation.clear();
+    if (Index > 0)
+    {
+        mRotation = QChar('A' + (Index - 1) % 26);
+    }
+    mCallsign = mCopyCallsign + mRotation;
+}
+
+QString ClientView::MapCallsign(const QString &Callsign) const
+{
+    if (mCallsigns == 0 || !mCallsigns->contains(Callsign))
+    {
+        return Callsign;
+    }
+    // the clients of a copy go through the loops together
+    return mCallsigns->value(Callsign) + mRotation;
+}
+
+void ClientView::ApplyOffset(double &Lat, double &Long) const
+{
+    Lat = qBound(-90.0, Lat + mLatOffset, 90.0);
+    Long += mLongOffset;
+    if (Long > 180.0)
+    {
+        Long -= 360.0;
+    }
+    else if (Long < -180.0)
+    {
+        Long += 360.0;
+    }
+}
+
+
+ScenarioView::ScenarioView(const ClientContainer &Cont, int Copies, double LatOffset, double LongOffset, int TimeShift)
+{
+    QSet<QString> Callsigns;
+    for (auto iter = Cont.cbegin(); iter != Cont.cend(); ++iter)
+    {
+        Callsigns.insert((*iter)->GetCallsign());
+    }
+
+    reserve(Cont.size() * qMax(Copies, 1));
+    for (int copy = 0; copy < qMax(Copies, 1); copy++)
+    {
+        // the suffixes first, a text message goes to the counterpart of
+        // its receiver in the same copy
+        QStringList Suffixes;
+        auto Map = std::make_shared<QHash<QString, QString>>();
+        for (auto iter = Cont.cbegin(); iter != Cont.cend(); ++iter)
+        {
+            QString Suffix;
+            if (copy > 0)
+            {
+                // the suffix must not clash with a recorded callsign
+                Suffix = QString::number(copy);
+                while (Callsigns.contains((*iter)->GetCallsign() + Suffix))
+                {
+                    Suffix += "X";
+                }
+                Callsigns.insert((*iter)->GetCallsign() + Suffix);
+            }
+            Suffixes.append(Suffix);
+            Map->insert((*iter)->GetCallsign(), (*iter)->GetCallsign() + Suffix);
+        }
+        int Index = 0;
+        for (auto iter = Cont.cbegin(); iter != Cont.cend(); ++iter)
+        {
+            append(ClientView(*iter, Suffixes[Index++], copy * LatOffset, copy * LongOffset, copy * TimeShift, Map));
+        }
+    }
+}
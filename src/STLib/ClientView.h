@@ -0,0 +1,56 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CLIENT_VIEW_H_
+#define CLIENT_VIEW_H_
+
+#include "ClientContainer.h"
+
+// callsign of every client of the scenario in one copy
+typedef std::shared_ptr<const QHash<QString, QString>> pCallsignMap;
+
+// One replay of a client. The time updates are shared with the loaded
+// client, a view only adds the callsign suffix, the position offset and
+// the time shift of this copy.
+class ClientView
+{
+public:
+    ClientView(pClient client);
+    ClientView(pClient client, QString Suffix, double LatOffset, double LongOffset, int TimeShift,
+               pCallsignMap Callsigns = pCallsignMap());
+
+    pClient GetClient() const;
+    QString GetCallsign() const;
+    eClientType GetType() const;
+    int GetTimeShift() const;
+    // a callsign of its own for every loop of a soak test, 0 is the
+    // callsign of the copy
+    void SetRotation(int Index);
+    // the counterpart of a recorded callsign in this copy, others stay
+    // as they are
+    QString MapCallsign(const QString &Callsign) const;
+
+    void ApplyOffset(double &Lat, double &Long) const;
+
+private:
+    pClient mClient;
+    QString mCopyCallsign;
+    QString mCallsign;
+    QString mRotation;
+    pCallsignMap mCallsigns;
+    double mLatOffset;
+    double mLongOffset;
+    int mTimeShift;
+};
+
+// All clients of a container, each one replayed Copies times. Copy 0 is
+// the original, copy i is shifted by i times the given offsets.
+class ScenarioView : public QList<ClientView>
+{
+public:
+    ScenarioView(const ClientContainer &Cont, int Copies = 1, double LatOffset = 0.0, double LongOffset = 0.0, int TimeShift = 0);
+};
+
+#endif
@@ -0,0 +1,333 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "FSInnReader.h"
+#include "exporter.h"
+
+FSInnReader::FSInnReader(QString Filename)
+    : mFile(Filename)
+{
+}
+
+bool FSInnReader::Open()
+{
+    if (!mFile.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(mFile.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool FSInnReader::ReadEvent(LogEvent &Event)
+{
+    while (!mFile.atEnd())
+    {
+        QString Line = "";
+        if (!ReadLine(mFile, Line))
+        {
+            return false;
+        }
+        Event.Argument.clear();
+        if (ExportLine(Line, Event.Time, Event.Dir, Event.Reason, Event.Argument))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FSInnReader::ReadNewEvent(LogEvent &Event)
+{
+    while (true)
+    {
+        int NewLine = mPartial.indexOf('\n');
+        if (NewLine < 0)
+        {
+            // whatever was written since the last call, a line may still
+            // be incomplete
+            QByteArray Data = mFile.read(ChunkSize);
+            if (Data.isEmpty())
+            {
+                return false;
+            }
+            mPartial += Data;
+            continue;
+        }
+        QString Line = QString::fromUtf8(mPartial.constData(), NewLine + 1);
+        mPartial.remove(0, NewLine + 1);
+        if (Line.endsWith("\r\n"))
+        {
+            Line.remove(Line.size() - 2, 1);
+        }
+        Event.Argument.clear();
+        if (ExportLine(Line, Event.Time, Event.Dir, Event.Reason, Event.Argument))
+        {
+            return true;
+        }
+    }
+}
+
+void FSInnReader::Close()
+{
+    mFile.close();
+    mPartial.clear();
+}
+
+bool FSInnReader::HasError() const
+{
+    return mFile.HasError();
+}
+
+QString FSInnReader::GetError() const
+{
+    return mFile.errorString();
+}
+
+bool FSInnReader::ReadFile(ClientContainer &Cont)
+{
+    if (!Open())
+    {
+        return false;
+    }
+    bool needStartTime = true;
+    LogEvent Event;
+    while (ReadEvent(Event))
+    {
+        ApplyEvent(Event, Cont);
+        if (needStartTime)
+        {
+            Cont.SetStartTime(Event.Time);
+            needStartTime = false;
+        }
+    }
+    bool Ok = !HasError();
+    Close();
+
+    return Ok;
+}
+
+QString FSInnReader::GetCallsign(const LogEvent &Event)
+{
+    QList<QString> List = Seperate(Event.Argument, ':');
+    int Index = Event.Reason == PositionAirplaneReason ? 1 : 0;
+    return Index < List.size() ? List[Index] : QString();
+}
+
+pClient FSInnReader::ApplyEvent(const LogEvent &Event, ClientContainer &Cont)
+{
+    pClient client;
+    switch (Event.Reason)
+    {
+    case AddAirplaneReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[0];
+            client = Cont.SearchClient(Callsign, AirplaneType);
+            client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(AddAirplaneReason, Event.Time)));
+        }
+        break;
+    case RemoveAirplaneReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[0];
+            client = Cont.SearchClient(Callsign, AirplaneType);
+            client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(RemoveAirplaneReason, Event.Time)));
+        }
+        break;
+    case AddATCReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[0];
+            client = Cont.SearchClient(Callsign, ControllerType);
+            client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(AddATCReason, Event.Time)));
+        }
+        break;
+    case RemoveATCReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[0];
+            client = Cont.SearchClient(Callsign, ControllerType);
+            client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(RemoveATCReason, Event.Time)));
+        }
+        break;
+    case PositionAirplaneReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[1];
+            client = Cont.SearchClient(Callsign, AirplaneType);
+            client->AddTimeUpdate(pTimeUpdate(new AirplanePositionUpdate(Event.Time, Event.Argument)));
+        }
+        break;
+    case PositionATCReason:
+        {
+            QString Callsign = (Seperate(Event.Argument, ':'))[0];
+            client = Cont.SearchClient(Callsign, ControllerType);
+            client->AddTimeUpdate(pTimeUpdate(new ControllerPositionUpdate(Event.Time, Event.Argument)));
+        }
+        break;
+    case TextMsg:
+        {
+            if (Event.Dir == eRecv)
+            {
+                QString Callsign = (Seperate(Event.Argument, ':'))[0];
+                client = Cont.SearchClient(Callsign, NotDefinedType);
+                if (client != 0)
+                {
+                    client->AddTimeUpdate(pTimeUpdate(new TextMessageUpdate(Event.Time, Event.Argument)));
+                }
+            }
+        }
+        break;
+    case SBInfoReason:
+        {
+            QList<QString> List = Seperate(Event.Argument, ':');
+            if (List[2] == "FSIPI" || List[2] == "PI")
+            {
+                QString Callsign = List[0];
+                client = Cont.SearchClient(Callsign, AirplaneType);
+                Airplane *airplane = (Airplane *)client.get();
+                if (airplane != 0 && !airplane->IsAirplaneInfoSet())
+                {
+                    airplane->SetAirplaneInfo(Event.Argument);
+                }
+            }
+        }
+        break;
+    case NotInitReason:
+    default:
+        break;
+    }
+    return client;
+}
+
+bool FSInnReader::ExportLine(QString &Line, int &time, Direction &direction, UpdateReason &command, QString &Argument)
+{
+    time = 0;
+    direction = eDNotInit;
+    command = NotInitReason;
+
+    bool pars_time = false;
+    bool pars_time_was = false;
+    bool pars_command = false;
+    bool pars_argument = false;
+    QString TimeStr = "";
+    for (int i = 1; i < Line.size(); i++)
+    {
+        // Time export:
+        if (Line[i] == '[' && !pars_time_was)
+        {
+            pars_time = true;
+            pars_time_was = true;
+        }
+        else if (pars_time && Line[i] == ' ')
+        {
+            pars_time = false;
+            time = ConvertTimeStr(TimeStr);
+        }
+        if (pars_time && Line[i] != '[')
+        {
+            TimeStr += Line[i];
+        }
+
+        // argument export:
+        if (pars_argument)
+        {
+            if (Line[i] != '<' && Line.size() - 1 != i)
+            {
+                Argument += Line[i];
+            }
+        }
+        // command export:
+        if (pars_command)
+        {
+            if (Line[i] == '@')
+            {
+                command = PositionAirplaneReason;
+            }
+            else if (Line[i] == '%')
+            {
+                command = PositionATCReason;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'A' && Line[i + 2] == 'P')
+            {
+                command = AddAirplaneReason;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'D' && Line[i + 2] == 'P')
+            {
+                command = RemoveAirplaneReason;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'A' && Line[i + 2] == 'A')
+            {
+                command = AddATCReason;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'D' && Line[i + 2] == 'A')
+            {
+                command = RemoveATCReason;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'T' && Line[i + 2] == 'M')
+            {
+                command = TextMsg;
+            }
+            else if (Line[i] == '#' && Line[i + 1] == 'S' && Line[i + 2] == 'B')
+            {
+                command = SBInfoReason;
+            }
+            else
+            {
+                return false;
+            }
+            if (Line[i] == '#')
+            {
+                i += 2;
+            }
+            pars_argument = true;
+            pars_command = false;
+        }
+
+        // direction export:
+        if (Line[i] == 'F' && Line[i + 1] == 'S' && Line[i + 2] == 'D' && Line[i + 3] ==  ' ')
+        {
+            if (Line[i + 4] == 'S' && Line[i + 5] == 'e' && Line[i + 6] == 'n' && Line[i + 7] == 't') // Sent
+            {
+                direction = eSent;
+            }
+            else if (Line[i + 4] == 'R' && Line[i + 5] == 'e' && Line[i + 6] == 'c' && Line[i + 7] == 'v') // Recv
+            {
+                direction = eRecv;
+            }
+            i += 9;
+            pars_command = true;
+        }
+    }
+
+    return true;
+}
+
+int FSInnReader::ConvertTimeStr(QString &TimeStr)
+{
+    int h = TimeStr[0].digitValue() * 10 + TimeStr[1].digitValue();
+    int min = TimeStr[3].digitValue() * 10 + TimeStr[4].digitValue();
+    int sek = TimeStr[6].digitValue() * 10 + TimeStr[7].digitValue();
+    int hund = TimeStr[9].digitValue() * 100 + TimeStr[10].digitValue() * 10 + TimeStr[11].digitValue();
+
+    return (((((h * 60) + min) * 60) + sek) * 1000) + hund;
+}
+
+
+
+bool ReadLine(QIODevice &File, QString &String)
+{
+    if (!File.isOpen())
+    {
+        return false;
+    }
+    char buf[1024];
+    qint64 lineLength = File.readLine(buf, sizeof(buf));
+    if (lineLength == -1)
+    {
+        return false;
+    }
+    String = buf;
+    return true;
+}
+
+
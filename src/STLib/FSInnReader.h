@@ -0,0 +1,62 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FS_INN_READER_H_
+#define FS_INN_READER_H_
+
+#include "ClientContainer.h"
+#include "GzipFile.h"
+
+enum Direction
+{
+    eDNotInit,
+    eSent,
+    eRecv,
+};
+
+// one line of a log
+struct LogEvent
+{
+    int Time;
+    Direction Dir;
+    UpdateReason Reason;
+    QString Argument;
+};
+
+class FSInnReader
+{
+public:
+    FSInnReader(QString Filename);
+    bool ReadFile(ClientContainer &Cont);
+
+    // reads the log one event at a time
+    bool Open();
+    bool ReadEvent(LogEvent &Event);
+    // for a log that is still written, only complete lines give events,
+    // false when there is no new one yet
+    bool ReadNewEvent(LogEvent &Event);
+    void Close();
+    // a read or decompression error ended ReadEvent, not the end of the log
+    bool HasError() const;
+    QString GetError() const;
+
+    static QString GetCallsign(const LogEvent &Event);
+    // returns the client the event belongs to, the new update is the
+    // last one of its list
+    static pClient ApplyEvent(const LogEvent &Event, ClientContainer &Cont);
+
+private:
+    static const int ChunkSize = 64 * 1024;
+
+    GzipFile mFile;
+    QByteArray mPartial;
+
+    bool ExportLine(QString &Line, int &time, Direction &direction, UpdateReason &command, QString &Argument);
+    int ConvertTimeStr(QString &TimeStr);
+};
+
+bool ReadLine(QIODevice &File, QString &String);
+
+#endif
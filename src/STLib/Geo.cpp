@@ -0,0 +1,74 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "Geo.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double DegToRad = 3.14159265358979323846 / 180.0;
+}
+
+double GreatCircleDistance(double Lat1, double Long1, double Lat2, double Long2)
+{
+    // haversine, good enough for everything below antipodal distances
+    double dLat = (Lat2 - Lat1) * DegToRad;
+    double dLong = (Long2 - Long1) * DegToRad;
+    double a = std::sin(dLat / 2) * std::sin(dLat / 2) +
+               std::cos(Lat1 * DegToRad) * std::cos(Lat2 * DegToRad) * std::sin(dLong / 2) * std::sin(dLong / 2);
+    return 2.0 * EarthRadiusNm * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+}
+
+double InitialBearing(double Lat1, double Long1, double Lat2, double Long2)
+{
+    double phi1 = Lat1 * DegToRad;
+    double phi2 = Lat2 * DegToRad;
+    double dLong = (Long2 - Long1) * DegToRad;
+    double y = std::sin(dLong) * std::cos(phi2);
+    double x = std::cos(phi1) * std::sin(phi2) - std::sin(phi1) * std::cos(phi2) * std::cos(dLong);
+    return std::fmod(std::atan2(y, x) / DegToRad + 360.0, 360.0);
+}
+
+void GreatCircleInterpolate(double Lat1, double Long1, double Lat2, double Long2, double Fraction,
+                            double &Lat, double &Long)
+{
+    double distance = GreatCircleDistance(Lat1, Long1, Lat2, Long2) / EarthRadiusNm;
+    if (distance < 1e-9)
+    {
+        Lat = Lat1 + (Lat2 - Lat1) * Fraction;
+        Long = Long1 + (Long2 - Long1) * Fraction;
+        return;
+    }
+    double a = std::sin((1.0 - Fraction) * distance) / std::sin(distance);
+    double b = std::sin(Fraction * distance) / std::sin(distance);
+    double phi1 = Lat1 * DegToRad;
+    double phi2 = Lat2 * DegToRad;
+    double lambda1 = Long1 * DegToRad;
+    double lambda2 = Long2 * DegToRad;
+    double x = a * std::cos(phi1) * std::cos(lambda1) + b * std::cos(phi2) * std::cos(lambda2);
+    double y = a * std::cos(phi1) * std::sin(lambda1) + b * std::cos(phi2) * std::sin(lambda2);
+    double z = a * std::sin(phi1) + b * std::sin(phi2);
+    Lat = std::atan2(z, std::sqrt(x * x + y * y)) / DegToRad;
+    Long = std::atan2(y, x) / DegToRad;
+}
+
+double InterpolateHeading(double Heading1, double Heading2, double Fraction)
+{
+    double turn = std::fmod(Heading2 - Heading1 + 540.0, 360.0) - 180.0;
+    return std::fmod(Heading1 + turn * Fraction + 360.0, 360.0);
+}
+
+GeoVector ToGeoVector(double Lat, double Long)
+{
+    double phi = Lat * DegToRad;
+    double lambda = Long * DegToRad;
+    return {std::cos(phi) * std::cos(lambda), std::cos(phi) * std::sin(lambda), std::sin(phi)};
+}
+
+double RangeToMinDot(double Range)
+{
+    return std::cos(std::min(std::max(Range, 0.0) / EarthRadiusNm, 3.14159265358979323846));
+}
@@ -0,0 +1,38 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef GEO_H_
+#define GEO_H_
+
+// mean earth radius in nautical miles
+const double EarthRadiusNm = 3440.065;
+
+// great circle distance between two points in decimal degrees, result in nm
+double GreatCircleDistance(double Lat1, double Long1, double Lat2, double Long2);
+
+// initial course in degrees from point 1 to point 2
+double InitialBearing(double Lat1, double Long1, double Lat2, double Long2);
+
+// point at Fraction (0..1) of the great circle from point 1 to point 2
+void GreatCircleInterpolate(double Lat1, double Long1, double Lat2, double Long2, double Fraction,
+                            double &Lat, double &Long);
+
+// heading at Fraction (0..1) of the shorter turn from Heading1 to Heading2
+double InterpolateHeading(double Heading1, double Heading2, double Fraction);
+
+// point on the unit sphere, two points are within a range when the dot
+// product of their vectors is at least RangeToMinDot of it
+struct GeoVector
+{
+    double X;
+    double Y;
+    double Z;
+};
+
+GeoVector ToGeoVector(double Lat, double Long);
+
+double RangeToMinDot(double Range);
+
+#endif
@@ -0,0 +1,171 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cmath>
+#include "GeoFilter.h"
+#include "Geo.h"
+
+namespace
+{
+    const double DegToRad = 3.14159265358979323846 / 180.0;
+    // one degree of latitude
+    const double NmPerDegree = 60.0;
+
+    double WrapLong(double Long)
+    {
+        while (Long > 180.0)
+        {
+            Long -= 360.0;
+        }
+        while (Long < -180.0)
+        {
+            Long += 360.0;
+        }
+        return Long;
+    }
+
+    bool ParseNumbers(QString Text, int Count, QVector<double> &Numbers)
+    {
+        QStringList List = Text.split(',');
+        if (List.size() != Count)
+        {
+            return false;
+        }
+        Numbers.clear();
+        for (const QString &Item : List)
+        {
+            bool ok = false;
+            Numbers.append(Item.trimmed().toDouble(&ok));
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+GeoFilter::GeoFilter()
+    : mShape(NoShape), mSouth(-90.0), mWest(-180.0), mNorth(90.0), mEast(180.0),
+      mLat(0.0), mLong(0.0), mRange(0.0)
+{
+}
+
+GeoFilter GeoFilter::Box(double Lat1, double Long1, double Lat2, double Long2)
+{
+    GeoFilter Filter;
+    Filter.mShape = BoxShape;
+    Filter.mSouth = qMax(qMin(Lat1, Lat2), -90.0);
+    Filter.mNorth = qMin(qMax(Lat1, Lat2), 90.0);
+    Filter.mWest = WrapLong(Long1);
+    Filter.mEast = WrapLong(Long2);
+    return Filter;
+}
+
+GeoFilter GeoFilter::Radius(double Lat, double Long, double Range)
+{
+    GeoFilter Filter;
+    Filter.mShape = RadiusShape;
+    Filter.mLat = Lat;
+    Filter.mLong = WrapLong(Long);
+    Filter.mRange = qMax(Range, 0.0);
+
+    double RangeDeg = Filter.mRange / NmPerDegree;
+    Filter.mSouth = qMax(Lat - RangeDeg, -90.0);
+    Filter.mNorth = qMin(Lat + RangeDeg, 90.0);
+    double MaxLat = qMax(qAbs(Filter.mSouth), qAbs(Filter.mNorth));
+    if (MaxLat < 89.0 && RangeDeg / std::cos(MaxLat * DegToRad) < 180.0)
+    {
+        double LongDeg = RangeDeg / std::cos(MaxLat * DegToRad);
+        Filter.mWest = WrapLong(Filter.mLong - LongDeg);
+        Filter.mEast = WrapLong(Filter.mLong + LongDeg);
+    }
+    return Filter;
+}
+
+bool GeoFilter::ParseBox(QString Text)
+{
+    QVector<double> Numbers;
+    if (!ParseNumbers(Text, 4, Numbers))
+    {
+        return false;
+    }
+    *this = Box(Numbers[0], Numbers[1], Numbers[2], Numbers[3]);
+    return true;
+}
+
+bool GeoFilter::ParseRadius(QString Text)
+{
+    QVector<double> Numbers;
+    if (!ParseNumbers(Text, 3, Numbers))
+    {
+        return false;
+    }
+    *this = Radius(Numbers[0], Numbers[1], Numbers[2]);
+    return true;
+}
+
+bool GeoFilter::IsSet() const
+{
+    return mShape != NoShape;
+}
+
+bool GeoFilter::Contains(double Lat, double Long) const
+{
+    switch (mShape)
+    {
+    case BoxShape:
+        if (Lat < mSouth || Lat > mNorth)
+        {
+            return false;
+        }
+        if (mWest <= mEast)
+        {
+            return Long >= mWest && Long <= mEast;
+        }
+        return Long >= mWest || Long <= mEast;
+    case RadiusShape:
+        return GreatCircleDistance(mLat, mLong, Lat, Long) <= mRange;
+    case NoShape:
+    default:
+        return true;
+    }
+}
+
+bool GeoFilter::Matches(const Client &client) const
+{
+    if (!IsSet())
+    {
+        return true;
+    }
+    for (const pTimeUpdate &Update : *client.GetTimeUpdateContainer())
+    {
+        if (Update->GetUpdateReason() == PositionAirplaneReason)
+        {
+            const AirplanePositionUpdate *Pos = static_cast<const AirplanePositionUpdate *>(Update.get());
+            if (Contains(Pos->GetLat(), Pos->GetLong()))
+            {
+                return true;
+            }
+        }
+        else if (Update->GetUpdateReason() == PositionATCReason)
+        {
+            const ControllerPositionUpdate *Pos = static_cast<const ControllerPositionUpdate *>(Update.get());
+            if (Contains(Pos->GetLat(), Pos->GetLong()))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void GeoFilter::GetBounds(double &South, double &West, double &North, double &East) const
+{
+    South = mSouth;
+    West = mWest;
+    North = mNorth;
+    East = mEast;
+}
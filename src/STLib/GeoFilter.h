@@ -0,0 +1,53 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef GEO_FILTER_H_
+#define GEO_FILTER_H_
+
+#include "Client.h"
+
+// Area of a lat/long box or of a circle around a point. A box whose
+// west edge is east of its east edge crosses the date line. An unset
+// filter contains everything.
+class GeoFilter
+{
+public:
+    GeoFilter();
+
+    static GeoFilter Box(double Lat1, double Long1, double Lat2, double Long2);
+    static GeoFilter Radius(double Lat, double Long, double Range);
+
+    // "Lat1,Long1,Lat2,Long2" in decimal degrees
+    bool ParseBox(QString Text);
+    // "Lat,Long,Range" in decimal degrees and nm
+    bool ParseRadius(QString Text);
+
+    bool IsSet() const;
+    bool Contains(double Lat, double Long) const;
+    // the client has at least one position inside the area
+    bool Matches(const Client &client) const;
+
+    // box around the area, West > East if it crosses the date line
+    void GetBounds(double &South, double &West, double &North, double &East) const;
+
+private:
+    enum Shape
+    {
+        NoShape,
+        BoxShape,
+        RadiusShape,
+    };
+
+    Shape mShape;
+    double mSouth;
+    double mWest;
+    double mNorth;
+    double mEast;
+    double mLat;
+    double mLong;
+    double mRange;
+};
+
+#endif
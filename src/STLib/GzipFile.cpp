@@ -0,0 +1,240 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <climits>
+#include "GzipFile.h"
+
+namespace
+{
+    // window bits for a gzip header instead of a zlib one
+    const int GzipWindowBits = 15 + 16;
+}
+
+GzipFile::GzipFile(QString Filename)
+    : mFile(Filename), mCompressed(false), mInMember(false), mEof(false), mError(false)
+{
+}
+
+GzipFile::~GzipFile()
+{
+    close();
+}
+
+bool GzipFile::open(OpenMode Mode)
+{
+    bool Reading = (Mode & ReadOnly) != 0;
+    if (isOpen() || Reading == ((Mode & WriteOnly) != 0))
+    {
+        return false;
+    }
+    // the text translation happens on this side of the compression
+    if (!mFile.open(Mode & ~Text))
+    {
+        setErrorString(mFile.errorString());
+        return false;
+    }
+    mEof = false;
+    mError = false;
+    mStream.zalloc = Z_NULL;
+    mStream.zfree = Z_NULL;
+    mStream.opaque = Z_NULL;
+    mStream.next_in = Z_NULL;
+    mStream.avail_in = 0;
+
+    int Result = Z_OK;
+    if (Reading)
+    {
+        mCompressed = mFile.peek(2) == QByteArray("\x1f\x8b");
+        if (mCompressed)
+        {
+            Result = inflateInit2(&mStream, GzipWindowBits);
+        }
+    }
+    else
+    {
+        mCompressed = IsCompressedName(mFile.fileName());
+        if (mCompressed)
+        {
+            Result = deflateInit2(&mStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GzipWindowBits, 8, Z_DEFAULT_STRATEGY);
+        }
+    }
+    if (Result != Z_OK)
+    {
+        setErrorString("Cannot initialize zlib");
+        mFile.close();
+        return false;
+    }
+    mInMember = mCompressed;
+    if (mCompressed)
+    {
+        mBuffer.resize(BufferSize);
+    }
+    return QIODevice::open(Mode);
+}
+
+void GzipFile::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    bool Writing = isWritable();
+    QIODevice::close();
+    if (mCompressed && Writing)
+    {
+        Deflate(Z_FINISH);
+        deflateEnd(&mStream);
+    }
+    else if (mCompressed)
+    {
+        inflateEnd(&mStream);
+    }
+    mFile.close();
+    if (mFile.error() != QFile::NoError)
+    {
+        Fail(mFile.errorString());
+    }
+    mBuffer.clear();
+}
+
+bool GzipFile::isSequential() const
+{
+    return true;
+}
+
+bool GzipFile::atEnd() const
+{
+    return QIODevice::atEnd() && (mCompressed ? mEof : mFile.atEnd());
+}
+
+bool GzipFile::HasError() const
+{
+    return mError;
+}
+
+bool GzipFile::IsCompressed() const
+{
+    return mCompressed;
+}
+
+bool GzipFile::IsCompressedName(QString Filename)
+{
+    return Filename.endsWith(".gz", Qt::CaseInsensitive);
+}
+
+qint64 GzipFile::readData(char *Data, qint64 MaxSize)
+{
+    if (!mCompressed)
+    {
+        qint64 Read = mFile.read(Data, MaxSize);
+        if (Read < 0)
+        {
+            Fail(mFile.errorString());
+        }
+        return Read;
+    }
+
+    mStream.next_out = reinterpret_cast<Bytef *>(Data);
+    mStream.avail_out = static_cast<uInt>(qMin(MaxSize, static_cast<qint64>(UINT_MAX)));
+    uInt Wanted = mStream.avail_out;
+    while (mStream.avail_out > 0 && !mEof)
+    {
+        if (mStream.avail_in == 0)
+        {
+            qint64 Read = mFile.read(mBuffer.data(), mBuffer.size());
+            if (Read < 0)
+            {
+                Fail(mFile.errorString());
+                return -1;
+            }
+            if (Read == 0)
+            {
+                if (mInMember)
+                {
+                    Fail("Unexpected end of compressed file");
+                    return -1;
+                }
+                mEof = true;
+                break;
+            }
+            mStream.next_in = reinterpret_cast<Bytef *>(mBuffer.data());
+            mStream.avail_in = static_cast<uInt>(Read);
+        }
+        if (!mInMember)
+        {
+            // gzip files may be several members one after the other
+            inflateReset(&mStream);
+            mInMember = true;
+        }
+        int Result = inflate(&mStream, Z_NO_FLUSH);
+        if (Result == Z_STREAM_END)
+        {
+            mInMember = false;
+        }
+        else if (Result != Z_OK && Result != Z_BUF_ERROR)
+        {
+            Fail(mStream.msg != Z_NULL ? QString(mStream.msg) : QString("Damaged compressed file"));
+            return -1;
+        }
+    }
+    return Wanted - mStream.avail_out;
+}
+
+qint64 GzipFile::writeData(const char *Data, qint64 Size)
+{
+    if (!mCompressed)
+    {
+        qint64 Written = mFile.write(Data, Size);
+        if (Written < 0)
+        {
+            Fail(mFile.errorString());
+        }
+        return Written;
+    }
+
+    qint64 Done = 0;
+    while (Done < Size)
+    {
+        uInt Chunk = static_cast<uInt>(qMin(Size - Done, static_cast<qint64>(UINT_MAX)));
+        mStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(Data + Done));
+        mStream.avail_in = Chunk;
+        if (!Deflate(Z_NO_FLUSH))
+        {
+            return -1;
+        }
+        Done += Chunk;
+    }
+    return Size;
+}
+
+bool GzipFile::Deflate(int Flush)
+{
+    int Result;
+    do
+    {
+        mStream.next_out = reinterpret_cast<Bytef *>(mBuffer.data());
+        mStream.avail_out = static_cast<uInt>(mBuffer.size());
+        Result = deflate(&mStream, Flush);
+        if (Result == Z_STREAM_ERROR)
+        {
+            Fail("Compression failed");
+            return false;
+        }
+        qint64 Have = mBuffer.size() - mStream.avail_out;
+        if (Have > 0 && mFile.write(mBuffer.constData(), Have) != Have)
+        {
+            Fail(mFile.errorString());
+            return false;
+        }
+    }
+    while (mStream.avail_out == 0 || (Flush == Z_FINISH && Result != Z_STREAM_END));
+    return true;
+}
+
+void GzipFile::Fail(QString Error)
+{
+    mError = true;
+    setErrorString(Error);
+}
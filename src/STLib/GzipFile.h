@@ -0,0 +1,53 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef GZIP_FILE_H_
+#define GZIP_FILE_H_
+
+#include <QFile>
+#include <zlib.h>
+
+// A file that is read and written through zlib one buffer at a time, so
+// a compressed scenario or log is never inflated into memory as a
+// whole. Reading detects gzip files by their header and passes other
+// files through, writing compresses when the name ends in .gz.
+class GzipFile : public QIODevice
+{
+public:
+    GzipFile(QString Filename);
+    ~GzipFile();
+
+    bool open(OpenMode Mode) override;
+    void close() override;
+    bool isSequential() const override;
+    bool atEnd() const override;
+
+    // a read, write or compression error happened since the open
+    bool HasError() const;
+    bool IsCompressed() const;
+
+    static bool IsCompressedName(QString Filename);
+
+protected:
+    qint64 readData(char *Data, qint64 MaxSize) override;
+    qint64 writeData(const char *Data, qint64 Size) override;
+
+private:
+    bool Deflate(int Flush);
+    void Fail(QString Error);
+
+    static const int BufferSize = 64 * 1024;
+
+    QFile mFile;
+    z_stream mStream;
+    QByteArray mBuffer;
+    bool mCompressed;
+    // the current gzip member has not ended yet
+    bool mInMember;
+    bool mEof;
+    bool mError;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include "LoadShape.h"
+
+namespace
+{
+    struct Session
+    {
+        int Start;
+        int End;
+        bool Controller;
+        bool LoggedOff;
+    };
+}
+
+LoadShape::LoadShape()
+    : mStartTime(0)
+{
+    mIntervals.fill(0, MaxInterval + 1);
+    Prepare();
+}
+
+void LoadShape::Extract(const ClientContainer &Cont)
+{
+    mStartTime = Cont.GetStartTime();
+    mMinutes.clear();
+    mIntervals.fill(0, MaxInterval + 1);
+
+    // collect the online sessions in ms after the start
+    QVector<Session> Sessions;
+    int EndTime = 0;
+    for (const pClient &client : Cont)
+    {
+        bool Controller = client->GetType() == ControllerType;
+        bool Online = false;
+        Session Current = {0, 0, Controller, false};
+        int Time = 0;
+        int LastPosition = -1;
+        for (const pTimeUpdate &Update : *client->GetTimeUpdateContainer())
+        {
+            Time += Update->GetTimeDiff();
+            UpdateReason reason = Update->GetUpdateReason();
+            if (reason == RemoveAirplaneReason || reason == RemoveATCReason)
+            {
+                if (Online)
+                {
+                    Current.End = Time;
+                    Current.LoggedOff = true;
+                    Sessions.append(Current);
+                    Online = false;
+                }
+                LastPosition = -1;
+                continue;
+            }
+            if (!Online)
+            {
+                Current = {Time, Time, Controller, false};
+                Online = true;
+            }
+            Current.End = Time;
+            if (reason == PositionAirplaneReason)
+            {
+                if (LastPosition >= 0)
+                {
+                    mIntervals[qBound(0, (Time - LastPosition + 500) / 1000, static_cast<int>(MaxInterval))]++;
+                }
+                LastPosition = Time;
+                // thinned positions are sent in between
+                for (int Step : static_cast<const AirplanePositionUpdate *>(Update.get())->GetSteps())
+                {
+                    mIntervals[qBound(0, (Step + 500) / 1000, static_cast<int>(MaxInterval))]++;
+                    LastPosition += Step;
+                }
+            }
+        }
+        if (Online)
+        {
+            Sessions.append(Current);
+        }
+        EndTime = qMax(EndTime, Time);
+    }
+
+    // a session counts as concurrent in every minute it touches
+    mMinutes.fill({0, 0, 0, 0, 0, 0}, EndTime / 60000 + 2);
+    QVector<int> PilotDiff(mMinutes.size(), 0);
+    QVector<int> ControllerDiff(mMinutes.size(), 0);
+    for (const Session &session : Sessions)
+    {
+        int StartMinute = qMax(session.Start, 0) / 60000;
+        int EndMinute = qMax(session.End, 0) / 60000;
+        LoadShapeMinute &Start = mMinutes[StartMinute];
+        LoadShapeMinute &End = mMinutes[EndMinute];
+        if (session.Controller)
+        {
+            Start.ControllerLogons++;
+            End.ControllerLogoffs += session.LoggedOff ? 1 : 0;
+            ControllerDiff[StartMinute]++;
+            ControllerDiff[EndMinute + 1]--;
+        }
+        else
+        {
+            Start.PilotLogons++;
+            End.PilotLogoffs += session.LoggedOff ? 1 : 0;
+            PilotDiff[StartMinute]++;
+            PilotDiff[EndMinute + 1]--;
+        }
+    }
+    int Pilots = 0;
+    int Controllers = 0;
+    for (int i = 0; i < mMinutes.size(); i++)
+    {
+        Pilots += PilotDiff[i];
+        Controllers += ControllerDiff[i];
+        mMinutes[i].Pilots = Pilots;
+        mMinutes[i].Controllers = Controllers;
+    }
+    mMinutes.removeLast();
+    Prepare();
+}
+
+bool LoadShape::ReadFromXMLFile(QString Filename)
+{
+    QFile file(Filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+
+    mMinutes.clear();
+    mIntervals.fill(0, MaxInterval + 1);
+    QXmlStreamReader xmlReader(&file);
+    while (!xmlReader.atEnd())
+    {
+        xmlReader.readNext();
+        if (xmlReader.isStartElement() && xmlReader.name() == "LoadShape")
+        {
+            mStartTime = xmlReader.attributes().value("StartTime").toString().toInt();
+        }
+        else if (xmlReader.isStartElement() && xmlReader.name() == "Minute")
+        {
+            LoadShapeMinute Minute;
+            Minute.Pilots = xmlReader.attributes().value("Pilots").toString().toInt();
+            Minute.Controllers = xmlReader.attributes().value("Controllers").toString().toInt();
+            Minute.PilotLogons = xmlReader.attributes().value("PilotLogons").toString().toInt();
+            Minute.PilotLogoffs = xmlReader.attributes().value("PilotLogoffs").toString().toInt();
+            Minute.ControllerLogons = xmlReader.attributes().value("ControllerLogons").toString().toInt();
+            Minute.ControllerLogoffs = xmlReader.attributes().value("ControllerLogoffs").toString().toInt();
+            mMinutes.append(Minute);
+        }
+        else if (xmlReader.isStartElement() && xmlReader.name() == "Interval")
+        {
+            int Seconds = xmlReader.attributes().value("Seconds").toString().toInt();
+            mIntervals[qBound(0, Seconds, static_cast<int>(MaxInterval))] = xmlReader.attributes().value("Count").toString().toLongLong();
+        }
+    }
+    file.close();
+    if (xmlReader.hasError())
+    {
+        qDebug() << qPrintable(xmlReader.errorString());
+        return false;
+    }
+    Prepare();
+    return true;
+}
+
+bool LoadShape::WriteToXMLFile(QString Filename) const
+{
+    QFile file(Filename);
+    if (!file.open(QFile::WriteOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+
+    QXmlStreamWriter xmlWriter(&file);
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.writeStartDocument();
+    xmlWriter.writeStartElement("LoadShape");
+    xmlWriter.writeAttribute("StartTime", QString::number(mStartTime));
+    for (const LoadShapeMinute &Minute : mMinutes)
+    {
+        xmlWriter.writeStartElement("Minute");
+        xmlWriter.writeAttribute("Pilots", QString::number(Minute.Pilots));
+        xmlWriter.writeAttribute("Controllers", QString::number(Minute.Controllers));
+        xmlWriter.writeAttribute("PilotLogons", QString::number(Minute.PilotLogons));
+        xmlWriter.writeAttribute("PilotLogoffs", QString::number(Minute.PilotLogoffs));
+        xmlWriter.writeAttribute("ControllerLogons", QString::number(Minute.ControllerLogons));
+        xmlWriter.writeAttribute("ControllerLogoffs", QString::number(Minute.ControllerLogoffs));
+        xmlWriter.writeEndElement();
+    }
+    for (int i = 0; i < mIntervals.size(); i++)
+    {
+        if (mIntervals[i] > 0)
+        {
+            xmlWriter.writeStartElement("Interval");
+            xmlWriter.writeAttribute("Seconds", QString::number(i));
+            xmlWriter.writeAttribute("Count", QString::number(mIntervals[i]));
+            xmlWriter.writeEndElement();
+        }
+    }
+    xmlWriter.writeEndElement();
+    xmlWriter.writeEndDocument();
+    file.close();
+    if (xmlWriter.hasError() || file.error())
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+    return true;
+}
+
+int LoadShape::GetStartTime() const
+{
+    return mStartTime;
+}
+
+int LoadShape::GetDuration() const
+{
+    return mMinutes.size() * 60000;
+}
+
+const QVector<LoadShapeMinute> &LoadShape::GetMinutes() const
+{
+    return mMinutes;
+}
+
+int LoadShape::GetTotalPilotLogons() const
+{
+    return mLogonSum.isEmpty() ? 0 : static_cast<int>(mLogonSum.last());
+}
+
+int LoadShape::GetPeakPilots() const
+{
+    int Peak = 0;
+    for (const LoadShapeMinute &Minute : mMinutes)
+    {
+        Peak = qMax(Peak, Minute.Pilots);
+    }
+    return Peak;
+}
+
+int LoadShape::GetPeakControllers() const
+{
+    int Peak = 0;
+    for (const LoadShapeMinute &Minute : mMinutes)
+    {
+        Peak = qMax(Peak, Minute.Controllers);
+    }
+    return Peak;
+}
+
+int LoadShape::SampleLogonTime(std::mt19937 &Random) const
+{
+    if (GetTotalPilotLogons() == 0)
+    {
+        return std::uniform_int_distribution<int>(0, qMax(GetDuration() - 1, 0))(Random);
+    }
+    qint64 Pick = std::uniform_int_distribution<qint64>(0, mLogonSum.last() - 1)(Random);
+    int Minute = std::upper_bound(mLogonSum.begin(), mLogonSum.end(), Pick) - mLogonSum.begin();
+    return Minute * 60000 + std::uniform_int_distribution<int>(0, 59999)(Random);
+}
+
+int LoadShape::SamplePositionInterval(std::mt19937 &Random) const
+{
+    if (mIntervalSum.isEmpty() || mIntervalSum.last() == 0)
+    {
+        return 5000;
+    }
+    qint64 Pick = std::uniform_int_distribution<qint64>(0, mIntervalSum.last() - 1)(Random);
+    int Seconds = std::upper_bound(mIntervalSum.begin(), mIntervalSum.end(), Pick) - mIntervalSum.begin();
+    return qMax(Seconds, 1) * 1000;
+}
+
+void LoadShape::Prepare()
+{
+    // cumulative sums for sampling with a binary search
+    mLogonSum.clear();
+    qint64 Sum = 0;
+    for (const LoadShapeMinute &Minute : mMinutes)
+    {
+        Sum += Minute.PilotLogons;
+        mLogonSum.append(Sum);
+    }
+    mIntervalSum.clear();
+    Sum = 0;
+    for (qint64 Count : mIntervals)
+    {
+        Sum += Count;
+        mIntervalSum.append(Sum);
+    }
+}
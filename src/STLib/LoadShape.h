@@ -0,0 +1,60 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LOAD_SHAPE_H_
+#define LOAD_SHAPE_H_
+
+#include <random>
+#include "ClientContainer.h"
+
+struct LoadShapeMinute
+{
+    int Pilots;
+    int Controllers;
+    int PilotLogons;
+    int PilotLogoffs;
+    int ControllerLogons;
+    int ControllerLogoffs;
+};
+
+// Load of a scenario over the time of day: concurrent clients, logons
+// and logoffs per minute and the distribution of the intervals between
+// two positions of the same airplane.
+class LoadShape
+{
+public:
+    LoadShape();
+
+    void Extract(const ClientContainer &Cont);
+    bool ReadFromXMLFile(QString Filename);
+    bool WriteToXMLFile(QString Filename) const;
+
+    int GetStartTime() const;
+    int GetDuration() const;
+    const QVector<LoadShapeMinute> &GetMinutes() const;
+    int GetTotalPilotLogons() const;
+    int GetPeakPilots() const;
+    int GetPeakControllers() const;
+
+    // random logon time in ms after the start, distributed like the pilot logons
+    int SampleLogonTime(std::mt19937 &Random) const;
+    // random position interval in ms
+    int SamplePositionInterval(std::mt19937 &Random) const;
+
+    static const int MaxInterval = 60;
+
+private:
+    void Prepare();
+
+    int mStartTime;
+    QVector<LoadShapeMinute> mMinutes;
+    // position intervals in seconds, the last one counts everything above
+    QVector<qint64> mIntervals;
+
+    QVector<qint64> mLogonSum;
+    QVector<qint64> mIntervalSum;
+};
+
+#endif
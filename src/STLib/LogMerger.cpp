@@ -0,0 +1,172 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include <climits>
+#include <functional>
+#include <queue>
+#include "LogMerger.h"
+
+namespace
+{
+    QString ClientKey(const LogEvent &Event)
+    {
+        bool Controller = Event.Reason == AddATCReason || Event.Reason == RemoveATCReason ||
+                          Event.Reason == PositionATCReason;
+        return (Controller ? "ATC:" : "PILOT:") + FSInnReader::GetCallsign(Event);
+    }
+}
+
+LogMerger::LogMerger(const QStringList &Files)
+    : mLastPrune(INT_MIN), mDuplicates(0)
+{
+    for (const QString &File : Files)
+    {
+        mReaders.append(std::make_shared<FSInnReader>(File));
+    }
+}
+
+bool LogMerger::Merge(ClientContainer &Cont)
+{
+    typedef QPair<int, int> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> Heads;
+    QVector<LogEvent> Next(mReaders.size());
+    // lines without a command may have no time, they are left out
+    auto ReadNext = [&](int Input)
+    {
+        while (mReaders[Input]->ReadEvent(Next[Input]))
+        {
+            if (Next[Input].Reason != NotInitReason)
+            {
+                Heads.push(qMakePair(Next[Input].Time, Input));
+                return;
+            }
+        }
+    };
+
+    for (int i = 0; i < mReaders.size(); i++)
+    {
+        if (!mReaders[i]->Open())
+        {
+            return false;
+        }
+        ReadNext(i);
+    }
+
+    bool needStartTime = true;
+    while (!Heads.empty())
+    {
+        int Input = Heads.top().second;
+        Heads.pop();
+        if (Accept(Input, Next[Input]))
+        {
+            FSInnReader::ApplyEvent(Next[Input], Cont);
+            if (needStartTime)
+            {
+                Cont.SetStartTime(Next[Input].Time);
+                needStartTime = false;
+            }
+        }
+        else
+        {
+            mDuplicates++;
+        }
+        ReadNext(Input);
+    }
+
+    bool Ok = true;
+    for (auto &Reader : mReaders)
+    {
+        // a truncated log would otherwise be merged in part
+        if (Reader->HasError())
+        {
+            qDebug() << "Error: Cannot read file " << qPrintable(Reader->GetError());
+            Ok = false;
+        }
+        Reader->Close();
+    }
+    return Ok;
+}
+
+int LogMerger::GetDuplicates() const
+{
+    return mDuplicates;
+}
+
+bool LogMerger::Accept(int Input, const LogEvent &Event)
+{
+    switch (Event.Reason)
+    {
+    case AddAirplaneReason:
+    case AddATCReason:
+    case RemoveAirplaneReason:
+    case RemoveATCReason:
+    {
+        bool Add = Event.Reason == AddAirplaneReason || Event.Reason == AddATCReason;
+        QString Key = ClientKey(Event);
+        auto iter = mClients.find(Key);
+        if (iter == mClients.end())
+        {
+            mClients.insert(Key, {Input, INT_MIN, Event.Time, Add});
+            return true;
+        }
+        ClientState &State = iter.value();
+        if (State.Online == Add && static_cast<qint64>(Event.Time) - State.LastChange <= DuplicateWindow)
+        {
+            return false;
+        }
+        State.Online = Add;
+        State.LastChange = Event.Time;
+        if (Add)
+        {
+            // the first position after the logon decides the owner
+            State.LastPosition = INT_MIN;
+        }
+        return true;
+    }
+    case PositionAirplaneReason:
+    case PositionATCReason:
+    {
+        QString Key = ClientKey(Event);
+        auto iter = mClients.find(Key);
+        if (iter == mClients.end())
+        {
+            mClients.insert(Key, {Input, Event.Time, INT_MIN, true});
+            return true;
+        }
+        ClientState &State = iter.value();
+        if (State.Owner != Input && static_cast<qint64>(Event.Time) - State.LastPosition <= OwnerTimeout)
+        {
+            return false;
+        }
+        State.Owner = Input;
+        State.LastPosition = Event.Time;
+        return true;
+    }
+    case TextMsg:
+    {
+        if (static_cast<qint64>(Event.Time) - mLastPrune > DuplicateWindow)
+        {
+            for (auto iter = mMessages.begin(); iter != mMessages.end();)
+            {
+                iter = Event.Time - iter.value() > DuplicateWindow ? mMessages.erase(iter) : iter + 1;
+            }
+            mLastPrune = Event.Time;
+        }
+        auto iter = mMessages.find(Event.Argument);
+        if (iter != mMessages.end() && Event.Time - iter.value() <= DuplicateWindow)
+        {
+            return false;
+        }
+        mMessages.insert(Event.Argument, Event.Time);
+        return true;
+    }
+    case SBInfoReason:
+        return true;
+    case NotInitReason:
+    default:
+        return false;
+    }
+}
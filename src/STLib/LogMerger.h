@@ -0,0 +1,50 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LOG_MERGER_H_
+#define LOG_MERGER_H_
+
+#include <memory>
+#include "FSInnReader.h"
+
+// Merges logs of the same event, recorded at different places, into one
+// scenario. The logs are read in step by time, only the next event of
+// every log is held. A client seen by several logs keeps the positions
+// of one log as long as that log hears it, so the streams are not
+// interleaved. Logons, logoffs and text messages that more than one log
+// saw are taken once.
+class LogMerger
+{
+public:
+    LogMerger(const QStringList &Files);
+
+    bool Merge(ClientContainer &Cont);
+
+    int GetDuplicates() const;
+
+    // another log takes over the positions of a client after this long
+    static const int OwnerTimeout = 15000;
+    // the same logon, logoff or message within this time is a duplicate
+    static const int DuplicateWindow = 5000;
+
+private:
+    struct ClientState
+    {
+        int Owner;
+        int LastPosition;
+        int LastChange;
+        bool Online;
+    };
+
+    bool Accept(int Input, const LogEvent &Event);
+
+    QList<std::shared_ptr<FSInnReader>> mReaders;
+    QHash<QString, ClientState> mClients;
+    QHash<QString, int> mMessages;
+    int mLastPrune;
+    int mDuplicates;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "PacketSize.h"
+
+namespace
+{
+    int NumberSize(int Value)
+    {
+        return QString::number(Value).size();
+    }
+
+    int CoordinateSize(double Value)
+    {
+        return QString::number(Value, 'f', 5).size();
+    }
+}
+
+int EstimatePacketSize(const QString &Callsign, const TimeUpdate *Update)
+{
+    switch (Update->GetUpdateReason())
+    {
+    case PositionAirplaneReason:
+    {
+        // @N:Callsign:SQ:Rating:Lat:Long:Alt:Speed:pbh:Delta
+        const AirplanePositionUpdate *Pos = static_cast<const AirplanePositionUpdate *>(Update);
+        return 3 + Callsign.size() + 1 + 4 + 1 + NumberSize(Pos->GetRating()) + 1 +
+               CoordinateSize(Pos->GetLat()) + 1 + CoordinateSize(Pos->GetLong()) + 1 +
+               NumberSize(Pos->GetAlt()) + 1 + NumberSize(Pos->GetSpeed()) + 1 + 10 + 1 +
+               NumberSize(Pos->GetPressureDelta()) + 2;
+    }
+    case PositionATCReason:
+    {
+        // %Callsign:Frequency:FacilityType:VisRange:Rating:Lat:Long:Alt
+        const ControllerPositionUpdate *Pos = static_cast<const ControllerPositionUpdate *>(Update);
+        return 1 + Callsign.size() + 1 + NumberSize(Pos->GetFrequency()) + 1 +
+               NumberSize(Pos->GetFacilityType()) + 1 + NumberSize(Pos->GetVisRange()) + 1 +
+               NumberSize(Pos->GetRating()) + 1 + CoordinateSize(Pos->GetLat()) + 1 +
+               CoordinateSize(Pos->GetLong()) + 1 + NumberSize(Pos->GetAlt()) + 2;
+    }
+    case TextMsg:
+    {
+        // #TMCallsign:Receiver:Message
+        const TextMessageUpdate *Text = static_cast<const TextMessageUpdate *>(Update);
+        return 3 + Callsign.size() + 1 + Text->GetReceiver().toUtf8().size() + 1 +
+               Text->GetMessage().toUtf8().size() + 2;
+    }
+    case AddAirplaneReason:
+    case AddATCReason:
+        return LogonPacketSize + Callsign.size();
+    case RemoveAirplaneReason:
+    case RemoveATCReason:
+        return LogoffPacketSize + Callsign.size();
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,19 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PACKET_SIZE_H_
+#define PACKET_SIZE_H_
+
+#include "TimeUpdate.h"
+
+// logon and logoff lines carry the login data of the session, which is
+// not part of the scenario
+const int LogonPacketSize = 50;
+const int LogoffPacketSize = 13;
+
+// size of the FSD packet STd sends for an update, including the line end
+int EstimatePacketSize(const QString &Callsign, const TimeUpdate *Update);
+
+#endif
@@ -0,0 +1,200 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cmath>
+#include <QtEndian>
+#include "PositionColumns.h"
+
+namespace
+{
+    enum Column
+    {
+        TimeColumn,
+        SquawkModeColumn,
+        SquawkColumn,
+        RatingColumn,
+        LatColumn,
+        LongColumn,
+        AltColumn,
+        SpeedColumn,
+        PitchColumn,
+        BankColumn,
+        HeadingColumn,
+        PressureDeltaColumn,
+        ColumnCount
+    };
+
+    const quint64 ContinuationBits = Q_UINT64_C(0x8080808080808080);
+
+    qint64 Quantise(double Value, double Scale)
+    {
+        return static_cast<qint64>(std::llround(Value * Scale));
+    }
+
+    void AppendVarint(QByteArray &Data, qint64 Value)
+    {
+        quint64 Zigzag = (static_cast<quint64>(Value) << 1) ^ static_cast<quint64>(Value >> 63);
+        while (Zigzag >= 0x80)
+        {
+            Data.append(static_cast<char>((Zigzag & 0x7F) | 0x80));
+            Zigzag >>= 7;
+        }
+        Data.append(static_cast<char>(Zigzag));
+    }
+
+    // reads Count varints into Values, eight single byte values at a time
+    // where possible, and turns them back from differences into values
+    bool DecodeColumn(const uchar *&Pos, const uchar *End, int Count, qint64 *Values)
+    {
+        int i = 0;
+        while (i < Count)
+        {
+            if (Count - i >= 8 && End - Pos >= 8)
+            {
+                quint64 Word = qFromLittleEndian<quint64>(Pos);
+                if ((Word & ContinuationBits) == 0)
+                {
+                    for (int k = 0; k < 8; k++)
+                    {
+                        Values[i + k] = static_cast<qint64>((Word >> (8 * k)) & 0xFF);
+                    }
+                    Pos += 8;
+                    i += 8;
+                    continue;
+                }
+            }
+            quint64 Value = 0;
+            int Shift = 0;
+            while (true)
+            {
+                if (Pos == End || Shift > 63)
+                {
+                    return false;
+                }
+                uchar Byte = *Pos++;
+                Value |= static_cast<quint64>(Byte & 0x7F) << Shift;
+                if ((Byte & 0x80) == 0)
+                {
+                    break;
+                }
+                Shift += 7;
+            }
+            Values[i++] = static_cast<qint64>(Value);
+        }
+
+        qint64 Previous = 0;
+        for (i = 0; i < Count; i++)
+        {
+            quint64 Zigzag = static_cast<quint64>(Values[i]);
+            Previous += static_cast<qint64>(Zigzag >> 1) ^ -static_cast<qint64>(Zigzag & 1);
+            Values[i] = Previous;
+        }
+        return true;
+    }
+}
+
+bool IsColumnPosition(const TimeUpdate *Update)
+{
+    return Update->GetUpdateReason() == PositionAirplaneReason &&
+           static_cast<const AirplanePositionUpdate *>(Update)->GetSteps().isEmpty();
+}
+
+QByteArray EncodePositionColumns(const QVector<const AirplanePositionUpdate *> &Positions)
+{
+    QByteArray Data;
+    Data.reserve(Positions.size() * ColumnCount * 2);
+    for (int column = 0; column < ColumnCount; column++)
+    {
+        qint64 Previous = 0;
+        for (const AirplanePositionUpdate *Pos : Positions)
+        {
+            qint64 Value = 0;
+            switch (column)
+            {
+            case TimeColumn:
+                Value = Pos->GetTimeDiff();
+                break;
+            case SquawkModeColumn:
+                Value = Pos->GetSquawkMode().unicode();
+                break;
+            case SquawkColumn:
+                Value = Pos->GetSquawk();
+                break;
+            case RatingColumn:
+                Value = Pos->GetRating();
+                break;
+            case LatColumn:
+                Value = Quantise(Pos->GetLat(), ColumnPositionScale);
+                break;
+            case LongColumn:
+                Value = Quantise(Pos->GetLong(), ColumnPositionScale);
+                break;
+            case AltColumn:
+                Value = Pos->GetAlt();
+                break;
+            case SpeedColumn:
+                Value = Pos->GetSpeed();
+                break;
+            case PitchColumn:
+                Value = Quantise(Pos->GetPitch(), ColumnAngleScale);
+                break;
+            case BankColumn:
+                Value = Quantise(Pos->GetBank(), ColumnAngleScale);
+                break;
+            case HeadingColumn:
+                Value = Quantise(Pos->GetHeading(), ColumnAngleScale);
+                break;
+            case PressureDeltaColumn:
+                Value = Pos->GetPressureDelta();
+                break;
+            }
+            AppendVarint(Data, Value - Previous);
+            Previous = Value;
+        }
+    }
+    return Data;
+}
+
+bool DecodePositionColumns(const QByteArray &Data, int Count, TimeUpdateContainer &Positions)
+{
+    // every value takes at least one byte
+    if (Count <= 0 || Count > Data.size() / ColumnCount)
+    {
+        return false;
+    }
+    QVector<qint64> Values(Count * ColumnCount);
+    const uchar *Pos = reinterpret_cast<const uchar *>(Data.constData());
+    const uchar *End = Pos + Data.size();
+    for (int column = 0; column < ColumnCount; column++)
+    {
+        if (!DecodeColumn(Pos, End, Count, Values.data() + column * Count))
+        {
+            return false;
+        }
+    }
+    if (Pos != End)
+    {
+        return false;
+    }
+
+    const qint64 *Column = Values.constData();
+    for (int i = 0; i < Count; i++)
+    {
+        Positions.append(pTimeUpdate(new AirplanePositionUpdate(
+            static_cast<int>(Column[TimeColumn * Count + i]),
+            QChar(static_cast<ushort>(Column[SquawkModeColumn * Count + i])),
+            static_cast<int>(Column[SquawkColumn * Count + i]),
+            static_cast<int>(Column[RatingColumn * Count + i]),
+            Column[LatColumn * Count + i] / ColumnPositionScale,
+            Column[LongColumn * Count + i] / ColumnPositionScale,
+            static_cast<int>(Column[AltColumn * Count + i]),
+            static_cast<int>(Column[SpeedColumn * Count + i]),
+            Column[PitchColumn * Count + i] / ColumnAngleScale,
+            Column[BankColumn * Count + i] / ColumnAngleScale,
+            Column[HeadingColumn * Count + i] / ColumnAngleScale,
+            static_cast<int>(Column[PressureDeltaColumn * Count + i]))));
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef POSITION_COLUMNS_H_
+#define POSITION_COLUMNS_H_
+
+#include <QByteArray>
+#include <QVector>
+#include "TimeUpdate.h"
+
+// A run of airplane positions of one client, stored field by field.
+// Every field is a fixed point integer, written as the difference to the
+// same field of the previous position, zigzag mapped and as a varint.
+// Consecutive fixes differ by little, so most values take a single byte.
+
+// 1e-6 degree, the precision of Lat and Long in the xml
+const double ColumnPositionScale = 1e6;
+// 1e-3 degree for pitch, bank and heading, finer than the pbh of a log
+const double ColumnAngleScale = 1e3;
+// shorter runs are written as single positions
+const int MinColumnRun = 4;
+
+// thinned positions are never part of a run
+bool IsColumnPosition(const TimeUpdate *Update);
+
+QByteArray EncodePositionColumns(const QVector<const AirplanePositionUpdate *> &Positions);
+// appends Count positions, false if the data is damaged
+bool DecodePositionColumns(const QByteArray &Data, int Count, TimeUpdateContainer &Positions);
+
+#endif
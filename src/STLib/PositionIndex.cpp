@@ -0,0 +1,130 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <cmath>
+#include <QSet>
+#include "PositionIndex.h"
+
+PositionIndex::PositionIndex(double CellSize)
+    : mCellSize(CellSize > 0.0 ? CellSize : 1.0), mCount(0)
+{
+    mRows = static_cast<int>(std::ceil(180.0 / mCellSize));
+    mColumns = static_cast<int>(std::ceil(360.0 / mCellSize));
+}
+
+int PositionIndex::Row(double Lat) const
+{
+    return qBound(0, static_cast<int>(std::floor((Lat + 90.0) / mCellSize)), mRows - 1);
+}
+
+int PositionIndex::Column(double Long) const
+{
+    return qBound(0, static_cast<int>(std::floor((Long + 180.0) / mCellSize)), mColumns - 1);
+}
+
+void PositionIndex::Add(int Client, int Time, double Lat, double Long)
+{
+    Entry entry = {Client, Time, static_cast<float>(Lat), static_cast<float>(Long)};
+    mCells[Row(Lat) * mColumns + Column(Long)].append(entry);
+    mCount++;
+}
+
+void PositionIndex::Build(const ClientContainer &Cont)
+{
+    for (int i = 0; i < Cont.size(); i++)
+    {
+        // containers straight from a log hold absolute times, keep their
+        // sum in range
+        qint64 Sum = 0;
+        for (const pTimeUpdate &Update : *Cont[i]->GetTimeUpdateContainer())
+        {
+            Sum += Update->GetTimeDiff();
+            int Time = static_cast<int>(qBound(static_cast<qint64>(INT_MIN), Sum, static_cast<qint64>(INT_MAX)));
+            if (Update->GetUpdateReason() == PositionAirplaneReason)
+            {
+                const AirplanePositionUpdate *Pos = static_cast<const AirplanePositionUpdate *>(Update.get());
+                Add(i, Time, Pos->GetLat(), Pos->GetLong());
+                // thinned positions are replayed in between
+                const QVector<int> &Steps = Pos->GetSteps();
+                qint64 StepTime = Sum;
+                for (int Step = 0; Step < Steps.size() && !Pos->IsHold(); Step++)
+                {
+                    StepTime += Steps[Step];
+                    VatPilotPosition StepPos = Pos->GetPosUpdate(Step + 1);
+                    Add(i, static_cast<int>(qBound(static_cast<qint64>(INT_MIN), StepTime, static_cast<qint64>(INT_MAX))),
+                        StepPos.latitude, StepPos.longitude);
+                }
+            }
+            else if (Update->GetUpdateReason() == PositionATCReason)
+            {
+                const ControllerPositionUpdate *Pos = static_cast<const ControllerPositionUpdate *>(Update.get());
+                Add(i, Time, Pos->GetLat(), Pos->GetLong());
+            }
+        }
+    }
+}
+
+QVector<int> PositionIndex::Query(const GeoFilter &Filter, int From, int To) const
+{
+    double South, West, North, East;
+    Filter.GetBounds(South, West, North, East);
+
+    // a box across the date line is two column ranges
+    QVector<QPair<int, int>> Columns;
+    if (West <= East)
+    {
+        Columns.append(qMakePair(Column(West), Column(East)));
+    }
+    else
+    {
+        Columns.append(qMakePair(Column(West), mColumns - 1));
+        Columns.append(qMakePair(0, Column(East)));
+    }
+
+    QSet<int> Found;
+    for (int row = Row(South); row <= Row(North); row++)
+    {
+        for (const auto &Range : Columns)
+        {
+            for (int column = Range.first; column <= Range.second; column++)
+            {
+                auto iter = mCells.constFind(row * mColumns + column);
+                if (iter == mCells.constEnd())
+                {
+                    continue;
+                }
+                for (const Entry &entry : iter.value())
+                {
+                    if (entry.Time >= From && entry.Time <= To && !Found.contains(entry.Client) &&
+                        Filter.Contains(entry.Lat, entry.Long))
+                    {
+                        Found.insert(entry.Client);
+                    }
+                }
+            }
+        }
+    }
+
+    QVector<int> Result;
+    Result.reserve(Found.size());
+    for (int Client : Found)
+    {
+        Result.append(Client);
+    }
+    std::sort(Result.begin(), Result.end());
+    return Result;
+}
+
+int PositionIndex::GetPositionCount() const
+{
+    return mCount;
+}
+
+void PositionIndex::Clear()
+{
+    mCells.clear();
+    mCount = 0;
+}
@@ -0,0 +1,56 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef POSITION_INDEX_H_
+#define POSITION_INDEX_H_
+
+#include <climits>
+#include <QHash>
+#include <QVector>
+#include "ClientContainer.h"
+#include "GeoFilter.h"
+
+// Position events on a grid of lat/long cells, to find the clients that
+// were inside an area, optionally only within a time window. Only the
+// cells that hold positions take memory.
+class PositionIndex
+{
+public:
+    // CellSize in degrees
+    PositionIndex(double CellSize = 1.0);
+
+    void Add(int Client, int Time, double Lat, double Long);
+    // every position of the scenario, Client is the index in the
+    // container and Time the sum of the time differences
+    void Build(const ClientContainer &Cont);
+
+    // the clients with a position inside the area between From and To,
+    // in ascending order
+    QVector<int> Query(const GeoFilter &Filter, int From = INT_MIN, int To = INT_MAX) const;
+
+    int GetPositionCount() const;
+    void Clear();
+
+private:
+    // float keeps an entry at 16 bytes, good to a few metres
+    struct Entry
+    {
+        int Client;
+        int Time;
+        float Lat;
+        float Long;
+    };
+
+    int Row(double Lat) const;
+    int Column(double Long) const;
+
+    double mCellSize;
+    int mRows;
+    int mColumns;
+    int mCount;
+    QHash<int, QVector<Entry>> mCells;
+};
+
+#endif
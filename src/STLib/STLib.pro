@@ -1,4 +1,4 @@
-QT += core xml
+QT += core xml concurrent
 QT -= gui
 
 include(../../common.pri)
@@ -0,0 +1,169 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SPATIAL_GRID_SSE2
+#endif
+#include "SpatialGrid.h"
+
+namespace
+{
+    const double DegToRad = 3.14159265358979323846 / 180.0;
+    // one degree of latitude
+    const double NmPerDegree = 60.0;
+}
+
+int CountWithinRange(const double *X, const double *Y, const double *Z, const double *MinDot, int Count,
+                     const GeoVector &P)
+{
+    int Result = 0;
+    int i = 0;
+#ifdef SPATIAL_GRID_SSE2
+    __m128d px = _mm_set1_pd(P.X);
+    __m128d py = _mm_set1_pd(P.Y);
+    __m128d pz = _mm_set1_pd(P.Z);
+    for (; i + 2 <= Count; i += 2)
+    {
+        __m128d dot = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(X + i), px),
+                                            _mm_mul_pd(_mm_loadu_pd(Y + i), py)),
+                                 _mm_mul_pd(_mm_loadu_pd(Z + i), pz));
+        int mask = _mm_movemask_pd(_mm_cmpge_pd(dot, _mm_loadu_pd(MinDot + i)));
+        Result += (mask & 1) + (mask >> 1);
+    }
+#endif
+    for (; i < Count; i++)
+    {
+        if (X[i] * P.X + Y[i] * P.Y + Z[i] * P.Z >= MinDot[i])
+        {
+            Result++;
+        }
+    }
+    return Result;
+}
+
+SpatialGrid::SpatialGrid(double CellSize)
+    : mCellSize(CellSize > 0.0 ? CellSize : 1.0)
+{
+    mRows = static_cast<int>(std::ceil(180.0 / mCellSize));
+    mColumns = static_cast<int>(std::ceil(360.0 / mCellSize));
+    mCells.resize(mRows * mColumns);
+}
+
+int SpatialGrid::CellIndex(int Row, int Column) const
+{
+    Row = qBound(0, Row, mRows - 1);
+    Column = ((Column % mColumns) + mColumns) % mColumns;
+    return Row * mColumns + Column;
+}
+
+void SpatialGrid::Insert(int Id, double Lat, double Long, double Range)
+{
+    Remove(Id);
+
+    GeoVector Pos = ToGeoVector(Lat, Long);
+    double MinDot = RangeToMinDot(Range);
+    double RangeDeg = qMax(Range, 0.0) / NmPerDegree;
+    int FirstRow = static_cast<int>(std::floor((Lat - RangeDeg + 90.0) / mCellSize));
+    int LastRow = static_cast<int>(std::floor((Lat + RangeDeg + 90.0) / mCellSize));
+    FirstRow = qBound(0, FirstRow, mRows - 1);
+    LastRow = qBound(0, LastRow, mRows - 1);
+
+    // the circle gets wider in longitude towards the poles
+    int FirstColumn = 0;
+    int Columns = mColumns;
+    double MaxLat = qAbs(Lat) + RangeDeg;
+    if (MaxLat < 89.0)
+    {
+        double LongDeg = RangeDeg / std::cos(MaxLat * DegToRad);
+        if (LongDeg < 180.0)
+        {
+            FirstColumn = static_cast<int>(std::floor((Long - LongDeg + 180.0) / mCellSize));
+            int LastColumn = static_cast<int>(std::floor((Long + LongDeg + 180.0) / mCellSize));
+            Columns = qMin(LastColumn - FirstColumn + 1, mColumns);
+        }
+    }
+
+    QVector<int> &CellsOfId = mCellsOfId[Id];
+    for (int Row = FirstRow; Row <= LastRow; Row++)
+    {
+        for (int i = 0; i < Columns; i++)
+        {
+            int Index = CellIndex(Row, FirstColumn + i);
+            Cell &cell = mCells[Index];
+            cell.X.append(Pos.X);
+            cell.Y.append(Pos.Y);
+            cell.Z.append(Pos.Z);
+            cell.MinDot.append(MinDot);
+            cell.Id.append(Id);
+            CellsOfId.append(Index);
+        }
+    }
+}
+
+void SpatialGrid::Remove(int Id)
+{
+    auto iter = mCellsOfId.find(Id);
+    if (iter == mCellsOfId.end())
+    {
+        return;
+    }
+    for (int Index : iter.value())
+    {
+        // swap the last entry into the gap
+        Cell &cell = mCells[Index];
+        int i = cell.Id.indexOf(Id);
+        if (i < 0)
+        {
+            continue;
+        }
+        int Last = cell.Id.size() - 1;
+        cell.X[i] = cell.X[Last];
+        cell.Y[i] = cell.Y[Last];
+        cell.Z[i] = cell.Z[Last];
+        cell.MinDot[i] = cell.MinDot[Last];
+        cell.Id[i] = cell.Id[Last];
+        cell.X.removeLast();
+        cell.Y.removeLast();
+        cell.Z.removeLast();
+        cell.MinDot.removeLast();
+        cell.Id.removeLast();
+    }
+    mCellsOfId.erase(iter);
+}
+
+bool SpatialGrid::Contains(int Id) const
+{
+    return mCellsOfId.contains(Id);
+}
+
+int SpatialGrid::CountCovering(double Lat, double Long, int Exclude) const
+{
+    int Row = static_cast<int>(std::floor((Lat + 90.0) / mCellSize));
+    int Column = static_cast<int>(std::floor((Long + 180.0) / mCellSize));
+    const Cell &cell = mCells[CellIndex(Row, Column)];
+    GeoVector Pos = ToGeoVector(Lat, Long);
+    int Result = CountWithinRange(cell.X.constData(), cell.Y.constData(), cell.Z.constData(),
+                                  cell.MinDot.constData(), cell.Id.size(), Pos);
+    if (Exclude >= 0)
+    {
+        int i = cell.Id.indexOf(Exclude);
+        if (i >= 0 && cell.X[i] * Pos.X + cell.Y[i] * Pos.Y + cell.Z[i] * Pos.Z >= cell.MinDot[i])
+        {
+            Result--;
+        }
+    }
+    return Result;
+}
+
+void SpatialGrid::Clear()
+{
+    for (Cell &cell : mCells)
+    {
+        cell = Cell();
+    }
+    mCellsOfId.clear();
+}
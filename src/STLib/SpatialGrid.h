@@ -0,0 +1,57 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SPATIAL_GRID_H_
+#define SPATIAL_GRID_H_
+
+#include <QHash>
+#include <QVector>
+#include "Geo.h"
+
+// Receivers on a grid of lat/long cells. A receiver is stored in every
+// cell its range touches, so finding the receivers that see a point
+// only looks at the cell of the point.
+class SpatialGrid
+{
+public:
+    // CellSize in degrees
+    SpatialGrid(double CellSize = 1.0);
+
+    // Id sees every point within Range nm of Lat/Long, replaces an
+    // earlier entry of the same Id
+    void Insert(int Id, double Lat, double Long, double Range);
+    void Remove(int Id);
+    bool Contains(int Id) const;
+
+    // number of receivers that see Lat/Long, not counting Exclude
+    int CountCovering(double Lat, double Long, int Exclude = -1) const;
+
+    void Clear();
+
+private:
+    // structure of arrays, so the distance check runs over plain doubles
+    struct Cell
+    {
+        QVector<double> X;
+        QVector<double> Y;
+        QVector<double> Z;
+        QVector<double> MinDot;
+        QVector<int> Id;
+    };
+
+    int CellIndex(int Row, int Column) const;
+
+    double mCellSize;
+    int mRows;
+    int mColumns;
+    QVector<Cell> mCells;
+    QHash<int, QVector<int>> mCellsOfId;
+};
+
+// number of the Count points that are within their MinDot of P
+int CountWithinRange(const double *X, const double *Y, const double *Z, const double *MinDot, int Count,
+                     const GeoVector &P);
+
+#endif
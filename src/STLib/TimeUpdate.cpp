@@ -5,6 +5,43 @@
 
 #include "TimeUpdate.h"
 #include "exporter.h"
+#include "Geo.h"
+
+namespace
+{
+    // "5000*12 4990" for twelve times 5000 and one 4990
+    QString EncodeSteps(const QVector<int> &Steps)
+    {
+        QStringList List;
+        for (int i = 0; i < Steps.size();)
+        {
+            int Count = 1;
+            while (i + Count < Steps.size() && Steps[i + Count] == Steps[i])
+            {
+                Count++;
+            }
+            List.append(Count > 1 ? QString("%1*%2").arg(Steps[i]).arg(Count) : QString::number(Steps[i]));
+            i += Count;
+        }
+        return List.join(' ');
+    }
+
+    QVector<int> DecodeSteps(const QString &Text)
+    {
+        QVector<int> Steps;
+        for (const QString &Item : Text.split(' ', QString::SkipEmptyParts))
+        {
+            int Star = Item.indexOf('*');
+            int Count = Star < 0 ? 1 : Item.mid(Star + 1).toInt();
+            int Step = Item.left(Star < 0 ? Item.size() : Star).toInt();
+            for (int i = 0; i < Count; i++)
+            {
+                Steps.append(Step);
+            }
+        }
+        return Steps;
+    }
+}
 
 QString UpdateReasonToString(UpdateReason reason)
 {
@@ -99,7 +136,7 @@ void TimeUpdate::Serialize(QXmlStreamWriter *xmlWriter) const
 
 
 AirplanePositionUpdate::AirplanePositionUpdate(int TimeDiff, QString Line)
-    : TimeUpdate(PositionAirplaneReason, TimeDiff)
+    : TimeUpdate(PositionAirplaneReason, TimeDiff), mHold(false), mSegmentEnd(0)
 {
     QList<QString> List = Seperate(Line, ':');
     mSquawkMode = List[0][0];
@@ -115,8 +152,24 @@ AirplanePositionUpdate::AirplanePositionUpdate(int TimeDiff, QString Line)
     mPressureDelta = List[9].toInt();
 }
 
+AirplanePositionUpdate::AirplanePositionUpdate(int TimeDiff, const VatPilotPosition &Pos)
+    : TimeUpdate(PositionAirplaneReason, TimeDiff), mHold(false), mSegmentEnd(0)
+{
+    mSquawkMode = convertFromTransponderMode(Pos.transponderMode);
+    mSquawk = Pos.transponderCode;
+    mRating = Pos.rating;
+    mLat = Pos.latitude;
+    mLong = Pos.longitude;
+    mAlt = Pos.altitudeTrue;
+    mSpeed = Pos.groundSpeed;
+    mPitch = Pos.pitch;
+    mBank = Pos.bank;
+    mHeading = Pos.heading;
+    mPressureDelta = Pos.altitudePressure - Pos.altitudeTrue;
+}
+
 AirplanePositionUpdate::AirplanePositionUpdate(QXmlStreamReader *xmlReader)
-    : TimeUpdate(PositionAirplaneReason, xmlReader)
+    : TimeUpdate(PositionAirplaneReason, xmlReader), mHold(false), mSegmentEnd(0)
 {
     mSquawkMode = xmlReader->attributes().value("SquawkMode").toString()[0];
     mSquawk = xmlReader->attributes().value("Squawk").toString().toInt();
@@ -129,6 +182,23 @@ AirplanePositionUpdate::AirplanePositionUpdate(QXmlStreamReader *xmlReader)
     mBank = xmlReader->attributes().value("Bank").toString().toDouble();
     mHeading = xmlReader->attributes().value("Heading").toString().toDouble();
     mPressureDelta = xmlReader->attributes().value("PressureDelta").toString().toInt();
+    if (xmlReader->attributes().hasAttribute("Repeat"))
+    {
+        SetSteps(DecodeSteps(xmlReader->attributes().value("Repeat").toString()), true);
+    }
+    else if (xmlReader->attributes().hasAttribute("Steps"))
+    {
+        SetSteps(DecodeSteps(xmlReader->attributes().value("Steps").toString()), false);
+    }
+}
+
+AirplanePositionUpdate::AirplanePositionUpdate(int TimeDiff, QChar SquawkMode, int Squawk, int Rating, double Lat,
+                                               double Long, int Alt, int Speed, double Pitch, double Bank,
+                                               double Heading, int PressureDelta)
+    : TimeUpdate(PositionAirplaneReason, TimeDiff), mSquawkMode(SquawkMode), mSquawk(Squawk), mRating(Rating),
+      mLat(Lat), mLong(Long), mAlt(Alt), mSpeed(Speed), mPitch(Pitch), mBank(Bank), mHeading(Heading),
+      mPressureDelta(PressureDelta), mHold(false), mSegmentEnd(0)
+{
 }
 
 void AirplanePositionUpdate::Serialize(QXmlStreamWriter *xmlWriter) const
@@ -146,6 +216,10 @@ void AirplanePositionUpdate::Serialize(QXmlStreamWriter *xmlWriter) const
     xmlWriter->writeAttribute("Bank", QString::number(mBank));
     xmlWriter->writeAttribute("Heading", QString::number(mHeading));
     xmlWriter->writeAttribute("PressureDelta", QString::number(mPressureDelta));
+    if (!mSteps.isEmpty())
+    {
+        xmlWriter->writeAttribute(mHold ? "Repeat" : "Steps", EncodeSteps(mSteps));
+    }
     xmlWriter->writeEndElement();
 }
 
@@ -222,6 +296,65 @@ VatPilotPosition AirplanePositionUpdate::GetPosUpdate() const
     return pos;
 }
 
+void AirplanePositionUpdate::RoundAsSerialized()
+{
+    mLat = QString::number(mLat, 'f', 6).toDouble();
+    mLong = QString::number(mLong, 'f', 6).toDouble();
+    mPitch = QString::number(mPitch).toDouble();
+    mBank = QString::number(mBank).toDouble();
+    mHeading = QString::number(mHeading).toDouble();
+}
+
+void AirplanePositionUpdate::SetSteps(const QVector<int> &Steps, bool Hold)
+{
+    mSteps = Steps;
+    mHold = Hold;
+}
+
+const QVector<int> &AirplanePositionUpdate::GetSteps() const
+{
+    return mSteps;
+}
+
+bool AirplanePositionUpdate::IsHold() const
+{
+    return mHold;
+}
+
+void AirplanePositionUpdate::SetSegmentEnd(const AirplanePositionUpdate *End)
+{
+    mSegmentEnd = End;
+}
+
+VatPilotPosition AirplanePositionUpdate::GetPosUpdate(int Step) const
+{
+    if (Step <= 0 || Step > mSteps.size() || mHold || mSegmentEnd == 0)
+    {
+        return GetPosUpdate();
+    }
+    int Elapsed = 0;
+    for (int i = 0; i < Step; i++)
+    {
+        Elapsed += mSteps[i];
+    }
+    int Total = mSegmentEnd->GetTimeDiff();
+    return Interpolate(*mSegmentEnd, Total > 0 ? Elapsed / static_cast<double>(Total) : 1.0);
+}
+
+VatPilotPosition AirplanePositionUpdate::Interpolate(const AirplanePositionUpdate &End, double Fraction) const
+{
+    VatPilotPosition pos = GetPosUpdate();
+    pos.latitude = mLat + (End.mLat - mLat) * Fraction;
+    pos.longitude = mLong + (End.mLong - mLong) * Fraction;
+    pos.altitudeTrue = mAlt + qRound((End.mAlt - mAlt) * Fraction);
+    pos.altitudePressure = pos.altitudeTrue + mPressureDelta;
+    pos.groundSpeed = mSpeed + qRound((End.mSpeed - mSpeed) * Fraction);
+    pos.pitch = mPitch + (End.mPitch - mPitch) * Fraction;
+    pos.bank = mBank + (End.mBank - mBank) * Fraction;
+    pos.heading = InterpolateHeading(mHeading, End.mHeading, Fraction);
+    return pos;
+}
+
 
 ControllerPositionUpdate::ControllerPositionUpdate(int TimeDiff, QString Line)
     : TimeUpdate(PositionATCReason, TimeDiff)
@@ -236,6 +369,18 @@ ControllerPositionUpdate::ControllerPositionUpdate(int TimeDiff, QString Line)
     mAlt = List[7].toInt();
 }
 
+ControllerPositionUpdate::ControllerPositionUpdate(int TimeDiff, const VatAtcPosition &Pos)
+    : TimeUpdate(PositionATCReason, TimeDiff)
+{
+    mFrequency = Pos.frequency;
+    mFacilityType = Pos.facility;
+    mVisRange = Pos.visibleRange;
+    mRating = Pos.rating;
+    mLat = Pos.latitude;
+    mLong = Pos.longitude;
+    mAlt = Pos.elevation;
+}
+
 ControllerPositionUpdate::ControllerPositionUpdate(QXmlStreamReader *xmlReader)
     : TimeUpdate(PositionATCReason, xmlReader)
 {
@@ -310,6 +455,12 @@ VatAtcPosition ControllerPositionUpdate::GetPosUpdate() const
     return pos;
 }
 
+void ControllerPositionUpdate::RoundAsSerialized()
+{
+    mLat = QString::number(mLat, 'f', 6).toDouble();
+    mLong = QString::number(mLong, 'f', 6).toDouble();
+}
+
 
 TextMessageUpdate::TextMessageUpdate(int TimeDiff, QString Line)
     : TimeUpdate(TextMsg, TimeDiff)
@@ -355,6 +506,16 @@ VatTransponderMode AirplanePositionUpdate::convertToTransponderMode(QChar identi
         return vatTransponderModeStandby;
 }
 
+QChar AirplanePositionUpdate::convertFromTransponderMode(VatTransponderMode mode) const
+{
+    if (mode == vatTransponderModeCharlie)
+        return 'N';
+    else if (mode == vatTransponderModeIdent)
+        return 'Y';
+    else
+        return 'S';
+}
+
 void AirplanePositionUpdate::ConvertPBHToDoubles(unsigned int pbh, double &pitch, double &bank, double &heading)
 {
     int pitchRaw, bankRaw, headingRaw;
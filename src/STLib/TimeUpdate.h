@@ -56,7 +56,10 @@ class AirplanePositionUpdate : public TimeUpdate
 {
 public:
     AirplanePositionUpdate(int TimeDiff, QString Line);
+    AirplanePositionUpdate(int TimeDiff, const VatPilotPosition &Pos);
     AirplanePositionUpdate(QXmlStreamReader *xmlReader);
+    AirplanePositionUpdate(int TimeDiff, QChar SquawkMode, int Squawk, int Rating, double Lat, double Long,
+                           int Alt, int Speed, double Pitch, double Bank, double Heading, int PressureDelta);
 
     QString GetLine() const;
 
@@ -75,10 +78,27 @@ public:
     int GetPressureDelta() const;
 
     VatPilotPosition GetPosUpdate() const;
+    // rounds the values like the xml does
+    void RoundAsSerialized();
+
+    // positions left out after this one by the trajectory thinning, as
+    // ms after the previous send. Hold repeats this position, otherwise
+    // they are on the straight line to the end of the segment, which is
+    // the next position in the list.
+    void SetSteps(const QVector<int> &Steps, bool Hold);
+    const QVector<int> &GetSteps() const;
+    bool IsHold() const;
+    void SetSegmentEnd(const AirplanePositionUpdate *End);
+
+    // position of the Step-th left out send, 0 is this position itself
+    VatPilotPosition GetPosUpdate(int Step) const;
+    // position at Fraction (0..1) of the straight line to End
+    VatPilotPosition Interpolate(const AirplanePositionUpdate &End, double Fraction) const;
 
 private:
 
     VatTransponderMode convertToTransponderMode(QChar identifier) const;
+    QChar convertFromTransponderMode(VatTransponderMode mode) const;
     void ConvertPBHToDoubles(unsigned int pbh, double &pitch, double &bank, double &heading);
 
     QChar mSquawkMode;
@@ -92,6 +112,10 @@ private:
     double mBank;
     double mHeading;
     int mPressureDelta;
+
+    QVector<int> mSteps;
+    bool mHold;
+    const AirplanePositionUpdate *mSegmentEnd;
 };
 
 // LOWW_APP:28200:5:145:5:48.11028:16.56972:0
@@ -101,6 +125,7 @@ class ControllerPositionUpdate : public TimeUpdate
 {
 public:
     ControllerPositionUpdate(int TimeDiff, QString Line);
+    ControllerPositionUpdate(int TimeDiff, const VatAtcPosition &Pos);
     ControllerPositionUpdate(QXmlStreamReader *xmlReader);
 
     QString GetLine() const;
@@ -116,6 +141,8 @@ public:
     int GetAlt() const;
 
     VatAtcPosition GetPosUpdate() const;
+    // rounds the values like the xml does
+    void RoundAsSerialized();
 
 private:
     int mFrequency;
@@ -0,0 +1,294 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtConcurrent>
+#include "TrafficGenerator.h"
+#include "Geo.h"
+
+namespace
+{
+    struct Facility
+    {
+        VatFacilityType Type;
+        const char *Suffix;
+        int VisRange;
+    };
+
+    const Facility Facilities[] =
+    {
+        {vatFacilityTypeDEL, "DEL", 20},
+        {vatFacilityTypeGND, "GND", 20},
+        {vatFacilityTypeTWR, "TWR", 50},
+        {vatFacilityTypeAPP, "APP", 150},
+        {vatFacilityTypeCTR, "CTR", 600},
+    };
+    const int FacilityCount = sizeof(Facilities) / sizeof(Facilities[0]);
+
+    const char *Airlines[] = {"DLH", "AUA", "BAW", "AFR", "KLM", "SWR", "AAL", "DAL", "UAL", "EZY", "RYR"};
+    const int AirlineCount = sizeof(Airlines) / sizeof(Airlines[0]);
+
+    const char *AircraftTypes[] = {"A320", "A321", "B738", "A333", "B772", "B744", "E190", "CRJ9"};
+    const int AircraftTypeCount = sizeof(AircraftTypes) / sizeof(AircraftTypes[0]);
+
+    const Airport DefaultAirports[] =
+    {
+        {"EDDT", 52.5597, 13.2877, 122},
+        {"EDDF", 50.0333, 8.5706, 364},
+        {"EDDM", 48.3538, 11.7861, 1487},
+        {"LOWW", 48.1103, 16.5697, 600},
+        {"LSZH", 47.4647, 8.5492, 1416},
+        {"EGLL", 51.4706, -0.4619, 83},
+        {"LFPG", 49.0097, 2.5479, 392},
+        {"EHAM", 52.3086, 4.7639, -11},
+        {"KJFK", 40.6398, -73.7789, 13},
+        {"KBOS", 42.3656, -71.0096, 20},
+        {"KMIA", 25.7932, -80.2906, 8},
+        {"CYYZ", 43.6777, -79.6248, 569},
+    };
+
+    int Uniform(std::mt19937 &Random, int Min, int Max)
+    {
+        return std::uniform_int_distribution<int>(Min, Max)(Random);
+    }
+}
+
+TrafficGenerator::TrafficGenerator(quint32 Seed)
+    : mSeed(Seed), mShape(0)
+{
+    for (const Airport &airport : DefaultAirports)
+    {
+        mAirports.append(airport);
+    }
+}
+
+bool TrafficGenerator::LoadAirports(QString Filename)
+{
+    QFile file(Filename);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot read file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(file.errorString());
+        return false;
+    }
+    mAirports.clear();
+    while (!file.atEnd())
+    {
+        QString Line = QString::fromLatin1(file.readLine()).simplified();
+        if (Line.isEmpty() || Line.startsWith('#'))
+        {
+            continue;
+        }
+        QList<QString> List = Line.split(' ');
+        if (List.size() < 4)
+        {
+            qDebug() << "error: " << qPrintable(Line);
+            continue;
+        }
+        mAirports.append({List[0], List[1].toDouble(), List[2].toDouble(), List[3].toInt()});
+    }
+    file.close();
+    return true;
+}
+
+int TrafficGenerator::GetAirportCount() const
+{
+    return mAirports.size();
+}
+
+void TrafficGenerator::SetLoadShape(const LoadShape *Shape)
+{
+    mShape = Shape;
+}
+
+void TrafficGenerator::Generate(ClientContainer &Cont, int Flights, int Controllers, int StartTime, int Duration)
+{
+    if (mAirports.size() < 2)
+    {
+        Flights = 0;
+    }
+    if (mAirports.isEmpty())
+    {
+        Controllers = 0;
+    }
+
+    QVector<QPair<int, pClient>> Slots(Controllers + Flights);
+    for (int i = 0; i < Slots.size(); i++)
+    {
+        Slots[i].first = i;
+    }
+    QtConcurrent::blockingMap(Slots, [this, Controllers, StartTime, Duration](QPair<int, pClient> &Slot)
+    {
+        if (Slot.first < Controllers)
+        {
+            Slot.second = GenerateController(Slot.first, StartTime, Duration);
+        }
+        else
+        {
+            Slot.second = GenerateFlight(Slot.first - Controllers, StartTime, Duration);
+        }
+    });
+
+    Cont.reserve(Cont.size() + Slots.size());
+    for (auto &Slot : Slots)
+    {
+        Cont.append(Slot.second);
+    }
+    Cont.SetStartTime(StartTime);
+}
+
+pClient TrafficGenerator::GenerateFlight(int Index, int StartTime, int Duration) const
+{
+    std::seed_seq Seq{mSeed, static_cast<quint32>(Index), 0u};
+    std::mt19937 Random(Seq);
+
+    int DepIndex = Uniform(Random, 0, mAirports.size() - 1);
+    int DestIndex = Uniform(Random, 0, mAirports.size() - 2);
+    if (DestIndex >= DepIndex)
+    {
+        DestIndex++;
+    }
+    const Airport &Dep = mAirports[DepIndex];
+    const Airport &Dest = mAirports[DestIndex];
+
+    QString Airline = Airlines[Uniform(Random, 0, AirlineCount - 1)];
+    QString Callsign = Airline + QString::number(Index + 1);
+    pClient client(new Airplane(Callsign));
+    ((Airplane *)client.get())->SetAirplaneInfo(Callsign + ":SERVER:PI:GEN:EQUIPMENT=" +
+                                                AircraftTypes[Uniform(Random, 0, AircraftTypeCount - 1)] +
+                                                ":AIRLINE=" + Airline);
+
+    int EndTime = StartTime + Duration;
+    int Time = StartTime;
+    int Interval = PositionInterval;
+    if (mShape != 0)
+    {
+        Time += qMin(mShape->SampleLogonTime(Random), qMax(Duration - 1, 0));
+        Interval = mShape->SamplePositionInterval(Random);
+    }
+    else
+    {
+        Time += Uniform(Random, 0, qMax(Duration - 1, 0));
+    }
+    client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(AddAirplaneReason, Time)));
+
+    double Distance = GreatCircleDistance(Dep.Lat, Dep.Long, Dest.Lat, Dest.Long);
+    // short hops do not reach the flight levels
+    int Cruise = Uniform(Random, 300, 390) * 100;
+    Cruise = qMin(Cruise, qMax(Dep.Elevation, Dest.Elevation) + 3000 + static_cast<int>(Distance * 150.0));
+
+    VatPilotPosition Pos;
+    Pos.latitude = Dep.Lat;
+    Pos.longitude = Dep.Long;
+    Pos.altitudeTrue = Dep.Elevation;
+    Pos.altitudePressure = Dep.Elevation;
+    Pos.groundSpeed = 0;
+    Pos.heading = InitialBearing(Dep.Lat, Dep.Long, Dest.Lat, Dest.Long);
+    Pos.bank = 0.0;
+    Pos.pitch = 0.0;
+    Pos.onGround = true;
+    Pos.transponderCode = Uniform(Random, 1, 6) * 1000 + Uniform(Random, 0, 7) * 100 + Uniform(Random, 0, 7) * 10 + Uniform(Random, 0, 7);
+    Pos.transponderMode = vatTransponderModeStandby;
+    Pos.rating = vatPilotRatingStudent;
+
+    // taxi out
+    int TaxiEnd = Time + Uniform(Random, 3, 10) * 60000;
+    while (Time < TaxiEnd && Time < EndTime)
+    {
+        Time += Interval;
+        client->AddTimeUpdate(pTimeUpdate(new AirplanePositionUpdate(Time, Pos)));
+    }
+
+    // climb, cruise and descent along the great circle, 3 nm per 1000 ft down
+    Pos.onGround = false;
+    Pos.transponderMode = vatTransponderModeCharlie;
+    double Altitude = Dep.Elevation;
+    double Flown = 0.0;
+    while (Flown < Distance && Time < EndTime)
+    {
+        double DescentAltitude = Dest.Elevation + (Distance - Flown) / 3.0 * 1000.0;
+        if (DescentAltitude < Altitude)
+        {
+            Altitude = DescentAltitude;
+            Pos.groundSpeed = Altitude - Dest.Elevation < 3000.0 ? 140 : (Altitude < 10000.0 ? 250 : 300);
+            Pos.pitch = -2.5;
+        }
+        else if (Altitude < Cruise)
+        {
+            Altitude = qMin(static_cast<double>(Cruise), Altitude + 2000.0 * Interval / 60000.0);
+            Pos.groundSpeed = Altitude < 10000.0 ? 250 : 300;
+            Pos.pitch = 5.0;
+        }
+        else
+        {
+            Pos.groundSpeed = 450;
+            Pos.pitch = 0.0;
+        }
+        Flown += Pos.groundSpeed * Interval / 3600000.0;
+
+        GreatCircleInterpolate(Dep.Lat, Dep.Long, Dest.Lat, Dest.Long, qMin(Flown / Distance, 1.0),
+                               Pos.latitude, Pos.longitude);
+        if (Flown < Distance)
+        {
+            Pos.heading = InitialBearing(Pos.latitude, Pos.longitude, Dest.Lat, Dest.Long);
+        }
+        Pos.altitudeTrue = static_cast<int>(Altitude);
+        Pos.altitudePressure = Pos.altitudeTrue;
+        Time += Interval;
+        client->AddTimeUpdate(pTimeUpdate(new AirplanePositionUpdate(Time, Pos)));
+    }
+
+    // taxi in
+    Pos.onGround = true;
+    Pos.transponderMode = vatTransponderModeStandby;
+    Pos.altitudeTrue = Dest.Elevation;
+    Pos.altitudePressure = Dest.Elevation;
+    Pos.groundSpeed = 0;
+    Pos.pitch = 0.0;
+    TaxiEnd = Time + Uniform(Random, 2, 8) * 60000;
+    while (Time < TaxiEnd && Time < EndTime)
+    {
+        Time += Interval;
+        client->AddTimeUpdate(pTimeUpdate(new AirplanePositionUpdate(Time, Pos)));
+    }
+    if (Time < EndTime)
+    {
+        client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(RemoveAirplaneReason, Time + Interval)));
+    }
+    return client;
+}
+
+pClient TrafficGenerator::GenerateController(int Index, int StartTime, int Duration) const
+{
+    std::seed_seq Seq{mSeed, static_cast<quint32>(Index), 1u};
+    std::mt19937 Random(Seq);
+
+    // every airport gets DEL, GND, TWR, APP and CTR before any doubles up
+    const Airport &Apt = mAirports[Index % mAirports.size()];
+    const Facility &Fac = Facilities[(Index / mAirports.size()) % FacilityCount];
+    int Round = Index / (mAirports.size() * FacilityCount);
+    QString Callsign = Apt.Icao + (Round > 0 ? "_" + QString::number(Round) : QString()) + "_" + Fac.Suffix;
+    pClient client(new Controller(Callsign));
+
+    VatAtcPosition Pos;
+    Pos.frequency = 118000 + Uniform(Random, 0, 759) * 25;
+    Pos.facility = Fac.Type;
+    Pos.visibleRange = Fac.VisRange;
+    Pos.rating = vatAtcRatingController1;
+    Pos.latitude = Apt.Lat;
+    Pos.longitude = Apt.Long;
+    Pos.elevation = 0;
+
+    int EndTime = StartTime + Duration;
+    int Time = StartTime + Uniform(Random, 0, qMin(Duration, 60000));
+    client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(AddATCReason, Time)));
+    while (Time + ControllerInterval < EndTime)
+    {
+        Time += ControllerInterval;
+        client->AddTimeUpdate(pTimeUpdate(new ControllerPositionUpdate(Time, Pos)));
+    }
+    client->AddTimeUpdate(pTimeUpdate(new TimeUpdate(RemoveATCReason, EndTime)));
+    return client;
+}
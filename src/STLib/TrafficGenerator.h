@@ -0,0 +1,52 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TRAFFIC_GENERATOR_H_
+#define TRAFFIC_GENERATOR_H_
+
+#include <random>
+#include "ClientContainer.h"
+#include "LoadShape.h"
+
+struct Airport
+{
+    QString Icao;
+    double Lat;
+    double Long;
+    int Elevation;
+};
+
+// Generates flights between airports and controllers at them without
+// any recorded log. Every flight has its own random generator seeded
+// from the seed and its index, so the result does not depend on the
+// number of threads.
+class TrafficGenerator
+{
+public:
+    TrafficGenerator(quint32 Seed);
+
+    // one airport per line: ICAO Lat Long Elevation
+    bool LoadAirports(QString Filename);
+    int GetAirportCount() const;
+
+    // take logon times and position intervals from a recorded scenario
+    void SetLoadShape(const LoadShape *Shape);
+
+    // StartTime and Duration in ms
+    void Generate(ClientContainer &Cont, int Flights, int Controllers, int StartTime, int Duration);
+
+    static const int PositionInterval = 5000;
+    static const int ControllerInterval = 15000;
+
+private:
+    pClient GenerateFlight(int Index, int StartTime, int Duration) const;
+    pClient GenerateController(int Index, int StartTime, int Duration) const;
+
+    quint32 mSeed;
+    QList<Airport> mAirports;
+    const LoadShape *mShape;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <cmath>
+#include "TrajectoryThinner.h"
+#include "Geo.h"
+
+namespace
+{
+    AirplanePositionUpdate *Position(const TimeUpdateContainer &List, int Index)
+    {
+        return static_cast<AirplanePositionUpdate *>(List[Index].get());
+    }
+
+    double AngleDiff(double a, double b)
+    {
+        return qAbs(std::fmod(b - a + 540.0, 360.0) - 180.0);
+    }
+}
+
+TrajectoryThinner::TrajectoryThinner(double MaxDistance, double MaxHeading)
+    : mMaxDistance(qMax(MaxDistance, 0.0)), mMaxHeading(qMax(MaxHeading, 0.0))
+{
+}
+
+int TrajectoryThinner::Thin(Client &client) const
+{
+    TimeUpdateContainer &List = *client.GetTimeUpdateContainer();
+    TimeUpdateContainer Result;
+    bool Lines = mMaxDistance > 0.0 || mMaxHeading > 0.0;
+    int Removed = 0;
+    int i = 0;
+    while (i < List.size())
+    {
+        if (!IsThinnable(List[i].get()))
+        {
+            Result.append(List[i]);
+            i++;
+            continue;
+        }
+        AirplanePositionUpdate *Start = Position(List, i);
+
+        // a run of identical positions, the event after the run takes
+        // over their time, at the end of the list the last one stays
+        int j = i + 1;
+        while (j < List.size() && j - i - 1 < MaxSteps && IsThinnable(List[j].get()) && IsSame(*Start, *Position(List, j)))
+        {
+            j++;
+        }
+        if (j == List.size())
+        {
+            j--;
+        }
+        if (j - i - 1 > 0)
+        {
+            QVector<int> Steps;
+            int Sum = 0;
+            for (int k = i + 1; k < j; k++)
+            {
+                Steps.append(List[k]->GetTimeDiff());
+                Sum += List[k]->GetTimeDiff();
+            }
+            List[j]->SetTimeDiff(List[j]->GetTimeDiff() + Sum);
+            Start->SetSteps(Steps, true);
+            Result.append(List[i]);
+            Removed += Steps.size();
+            i = j;
+            continue;
+        }
+
+        // the longest straight line whose positions in between are all
+        // within the error bounds
+        int End = -1;
+        if (Lines && i + 1 < List.size() && IsThinnable(List[i + 1].get()) && IsSameState(*Start, *Position(List, i + 1)))
+        {
+            for (j = i + 2; j < List.size() && j - i - 1 <= MaxSteps; j++)
+            {
+                if (!IsThinnable(List[j].get()) || !IsSameState(*Start, *Position(List, j)))
+                {
+                    break;
+                }
+                int Total = 0;
+                for (int k = i + 1; k <= j; k++)
+                {
+                    Total += List[k]->GetTimeDiff();
+                }
+                if (Total <= 0)
+                {
+                    break;
+                }
+                bool Close = true;
+                int Elapsed = 0;
+                for (int k = i + 1; k < j && Close; k++)
+                {
+                    Elapsed += List[k]->GetTimeDiff();
+                    Close = IsClose(Start->Interpolate(*Position(List, j), Elapsed / static_cast<double>(Total)),
+                                    *Position(List, k));
+                }
+                if (!Close)
+                {
+                    break;
+                }
+                End = j;
+            }
+        }
+        if (End > 0)
+        {
+            QVector<int> Steps;
+            int Sum = 0;
+            for (int k = i + 1; k < End; k++)
+            {
+                Steps.append(List[k]->GetTimeDiff());
+                Sum += List[k]->GetTimeDiff();
+            }
+            List[End]->SetTimeDiff(List[End]->GetTimeDiff() + Sum);
+            Start->SetSteps(Steps, false);
+            Start->SetSegmentEnd(Position(List, End));
+            Removed += Steps.size();
+            Result.append(List[i]);
+            i = End;
+            continue;
+        }
+
+        Result.append(List[i]);
+        i++;
+    }
+    List = Result;
+    return Removed;
+}
+
+bool TrajectoryThinner::IsThinnable(const TimeUpdate *Update) const
+{
+    return Update->GetUpdateReason() == PositionAirplaneReason &&
+           static_cast<const AirplanePositionUpdate *>(Update)->GetSteps().isEmpty();
+}
+
+bool TrajectoryThinner::IsSame(const AirplanePositionUpdate &a, const AirplanePositionUpdate &b) const
+{
+    return IsSameState(a, b) && a.GetLat() == b.GetLat() && a.GetLong() == b.GetLong() &&
+           a.GetAlt() == b.GetAlt() && a.GetSpeed() == b.GetSpeed() && a.GetPitch() == b.GetPitch() &&
+           a.GetBank() == b.GetBank() && a.GetHeading() == b.GetHeading();
+}
+
+bool TrajectoryThinner::IsSameState(const AirplanePositionUpdate &a, const AirplanePositionUpdate &b) const
+{
+    return a.GetSquawkMode() == b.GetSquawkMode() && a.GetSquawk() == b.GetSquawk() &&
+           a.GetRating() == b.GetRating() && a.GetPressureDelta() == b.GetPressureDelta();
+}
+
+bool TrajectoryThinner::IsClose(const VatPilotPosition &Expected, const AirplanePositionUpdate &Actual) const
+{
+    return GreatCircleDistance(Expected.latitude, Expected.longitude, Actual.GetLat(), Actual.GetLong()) <= mMaxDistance &&
+           AngleDiff(Expected.heading, Actual.GetHeading()) <= mMaxHeading &&
+           AngleDiff(Expected.pitch, Actual.GetPitch()) <= mMaxHeading &&
+           AngleDiff(Expected.bank, Actual.GetBank()) <= mMaxHeading &&
+           qAbs(Expected.altitudeTrue - Actual.GetAlt()) <= MaxAltitudeError &&
+           qAbs(Expected.groundSpeed - Actual.GetSpeed()) <= MaxSpeedError;
+}
@@ -0,0 +1,41 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TRAJECTORY_THINNER_H_
+#define TRAJECTORY_THINNER_H_
+
+#include "Client.h"
+
+// Leaves out airplane positions that the replay can recreate. Runs of
+// identical positions keep only the first one and the times of the
+// others. Positions that are within the error bounds of the straight
+// line between two kept positions are recreated by interpolation.
+// Squawk, rating and pressure are never approximated.
+class TrajectoryThinner
+{
+public:
+    // MaxDistance in nm, MaxHeading in degrees, 0 only removes exact repeats
+    TrajectoryThinner(double MaxDistance, double MaxHeading);
+
+    // the times of the client must be relative, returns the number of
+    // positions left out
+    int Thin(Client &client) const;
+
+    static const int MaxAltitudeError = 50;
+    static const int MaxSpeedError = 5;
+    // longest segment, bounds the work of the line check
+    static const int MaxSteps = 120;
+
+private:
+    bool IsThinnable(const TimeUpdate *Update) const;
+    bool IsSame(const AirplanePositionUpdate &a, const AirplanePositionUpdate &b) const;
+    bool IsSameState(const AirplanePositionUpdate &a, const AirplanePositionUpdate &b) const;
+    bool IsClose(const VatPilotPosition &Expected, const AirplanePositionUpdate &Actual) const;
+
+    double mMaxDistance;
+    double mMaxHeading;
+};
+
+#endif
@@ -0,0 +1,385 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "FsdServer.h"
+#include "STLib/Geo.h"
+
+QString PacketTypeToString(FsdPacketType type)
+{
+    switch (type)
+    {
+    case PilotLogonPacket:
+        return "PilotLogon";
+    case AtcLogonPacket:
+        return "AtcLogon";
+    case PilotLogoffPacket:
+        return "PilotLogoff";
+    case AtcLogoffPacket:
+        return "AtcLogoff";
+    case PilotPositionPacket:
+        return "PilotPosition";
+    case AtcPositionPacket:
+        return "AtcPosition";
+    case InterimPositionPacket:
+        return "InterimPosition";
+    case TextMessagePacket:
+        return "TextMessage";
+    case OtherPacket:
+        return "Other";
+    case PacketTypeCount:
+        break;
+    }
+    return "something-else";
+}
+
+
+FsdConnection::FsdConnection(QTcpSocket *socket, FsdServer *server)
+    : QObject(server), mSocket(socket), mServer(server), mIsController(false),
+      mHasPosition(false), mLat(0.0), mLong(0.0), mVisRange(0)
+{
+    mSocket->setParent(this);
+    mSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(mSocket, &QTcpSocket::readyRead, this, &FsdConnection::ReadData);
+    connect(mSocket, &QTcpSocket::disconnected, this, &FsdConnection::Disconnected);
+
+    // vatlib waits for the server identification before it sends the logon
+    Send("$DISERVER:CLIENT:VATSIM FSD V3.13:" + QByteArray::number(QRandomGenerator::global()->generate(), 16) + "\r\n");
+}
+
+QByteArray FsdConnection::GetCallsign() const
+{
+    return mCallsign;
+}
+
+bool FsdConnection::IsLoggedIn() const
+{
+    return !mCallsign.isEmpty();
+}
+
+bool FsdConnection::IsController() const
+{
+    return mIsController;
+}
+
+bool FsdConnection::HasPosition() const
+{
+    return mHasPosition;
+}
+
+double FsdConnection::GetLat() const
+{
+    return mLat;
+}
+
+double FsdConnection::GetLong() const
+{
+    return mLong;
+}
+
+int FsdConnection::GetRange() const
+{
+    return mIsController ? mVisRange : mServer->GetPilotRange();
+}
+
+void FsdConnection::Send(const QByteArray &Packet)
+{
+    mSocket->write(Packet);
+}
+
+void FsdConnection::ReadData()
+{
+    mBuffer += mSocket->readAll();
+    int start = 0;
+    int end;
+    while ((end = mBuffer.indexOf('\n', start)) != -1)
+    {
+        int length = end - start;
+        if (length > 0 && mBuffer[end - 1] == '\r')
+        {
+            length--;
+        }
+        if (length > 0)
+        {
+            ProcessPacket(mBuffer.mid(start, length));
+        }
+        start = end + 1;
+    }
+    mBuffer.remove(0, start);
+}
+
+void FsdConnection::Disconnected()
+{
+    Logoff();
+    mServer->ConnectionClosed(this);
+    deleteLater();
+}
+
+void FsdConnection::ProcessPacket(const QByteArray &Packet)
+{
+    FsdPacketType type = OtherPacket;
+    if (Packet.startsWith('@'))
+    {
+        // @N:CS:SQ:Rating:Lat:Long:Alt:Speed:pbh:Flags
+        type = PilotPositionPacket;
+        QList<QByteArray> List = Packet.split(':');
+        if (List.size() > 5)
+        {
+            mLat = List[4].toDouble();
+            mLong = List[5].toDouble();
+            mHasPosition = true;
+        }
+    }
+    else if (Packet.startsWith('%'))
+    {
+        // %CS:Frequency:FacilityType:VisRange:Rating:Lat:Long:Alt
+        type = AtcPositionPacket;
+        QList<QByteArray> List = Packet.split(':');
+        if (List.size() > 6)
+        {
+            mVisRange = List[3].toInt();
+            mLat = List[5].toDouble();
+            mLong = List[6].toDouble();
+            mHasPosition = true;
+        }
+    }
+    else if (Packet.startsWith("#AP"))
+    {
+        type = PilotLogonPacket;
+        Logon(Packet.mid(3, Packet.indexOf(':') - 3), false);
+    }
+    else if (Packet.startsWith("#AA"))
+    {
+        type = AtcLogonPacket;
+        Logon(Packet.mid(3, Packet.indexOf(':') - 3), true);
+    }
+    else if (Packet.startsWith("#DP"))
+    {
+        type = PilotLogoffPacket;
+        Logoff();
+    }
+    else if (Packet.startsWith("#DA"))
+    {
+        type = AtcLogoffPacket;
+        Logoff();
+    }
+    else if (Packet.startsWith("#TM"))
+    {
+        type = TextMessagePacket;
+    }
+    else if (Packet.startsWith("#SB") && Packet.contains(":VI:"))
+    {
+        type = InterimPositionPacket;
+    }
+
+    mServer->CountPacket(type, Packet.size() + 2);
+
+    if (!IsLoggedIn())
+    {
+        return;
+    }
+    if (type == PilotPositionPacket || type == AtcPositionPacket)
+    {
+        mServer->FanOutPosition(this, Packet);
+    }
+    else if (type == TextMessagePacket || type == InterimPositionPacket)
+    {
+        // #TMfrom:to:message and #SBfrom:to:VI:... are directed packets
+        QList<QByteArray> List = Packet.split(':');
+        if (List.size() > 1)
+        {
+            mServer->Forward(List[1], Packet);
+        }
+    }
+}
+
+void FsdConnection::Logon(const QByteArray &Callsign, bool Controller)
+{
+    if (Callsign.isEmpty() || IsLoggedIn())
+    {
+        return;
+    }
+    if (!mServer->RegisterCallsign(Callsign, this))
+    {
+        Send("$ERserver:unknown:001:" + Callsign + ":Callsign in use\r\n");
+        mSocket->disconnectFromHost();
+        return;
+    }
+    mCallsign = Callsign;
+    mIsController = Controller;
+}
+
+void FsdConnection::Logoff()
+{
+    if (IsLoggedIn())
+    {
+        mServer->UnregisterCallsign(mCallsign);
+        mCallsign.clear();
+        mHasPosition = false;
+    }
+}
+
+
+FsdServer::FsdServer(bool FanOut, int PilotRange, QObject *parent)
+    : QTcpServer(parent), mFanOut(FanOut), mPilotRange(PilotRange), mQuitWhenIdle(false),
+      mConnections(0), mMaxConnections(0), mBytes(0), mFanOutPackets(0), mFanOutBytes(0),
+      mLastPackets(0), mLastBytes(0), mLastFanOutPackets(0)
+{
+    for (int i = 0; i < PacketTypeCount; i++)
+    {
+        mPackets[i] = 0;
+    }
+    mRunTime.start();
+    mIntervalTime.start();
+}
+
+bool FsdServer::RegisterCallsign(const QByteArray &Callsign, FsdConnection *Connection)
+{
+    if (mCallsigns.contains(Callsign))
+    {
+        return false;
+    }
+    mCallsigns.insert(Callsign, Connection);
+    return true;
+}
+
+void FsdServer::UnregisterCallsign(const QByteArray &Callsign)
+{
+    mCallsigns.remove(Callsign);
+}
+
+void FsdServer::CountPacket(FsdPacketType Type, int Bytes)
+{
+    mPackets[Type]++;
+    mBytes += Bytes;
+}
+
+void FsdServer::FanOutPosition(FsdConnection *Sender, const QByteArray &Packet)
+{
+    if (!mFanOut || !Sender->HasPosition())
+    {
+        return;
+    }
+    QByteArray Line = Packet + "\r\n";
+    for (auto iter = mCallsigns.cbegin(); iter != mCallsigns.cend(); ++iter)
+    {
+        FsdConnection *receiver = iter.value();
+        if (receiver == Sender || !receiver->HasPosition())
+        {
+            continue;
+        }
+        double distance = GreatCircleDistance(Sender->GetLat(), Sender->GetLong(), receiver->GetLat(), receiver->GetLong());
+        if (distance <= receiver->GetRange())
+        {
+            receiver->Send(Line);
+            mFanOutPackets++;
+            mFanOutBytes += Line.size();
+        }
+    }
+}
+
+void FsdServer::Forward(const QByteArray &Receiver, const QByteArray &Packet)
+{
+    if (!mFanOut)
+    {
+        return;
+    }
+    FsdConnection *receiver = mCallsigns.value(Receiver, 0);
+    if (receiver != 0)
+    {
+        QByteArray Line = Packet + "\r\n";
+        receiver->Send(Line);
+        mFanOutPackets++;
+        mFanOutBytes += Line.size();
+    }
+}
+
+void FsdServer::ConnectionClosed(FsdConnection * /* Connection */)
+{
+    mConnections--;
+    if (mQuitWhenIdle && mConnections == 0)
+    {
+        Report();
+        QCoreApplication::exit();
+    }
+}
+
+int FsdServer::GetPilotRange() const
+{
+    return mPilotRange;
+}
+
+void FsdServer::SetQuitWhenIdle(bool Quit)
+{
+    mQuitWhenIdle = Quit;
+}
+
+void FsdServer::Report()
+{
+    quint64 packets = 0;
+    for (int i = 0; i < PacketTypeCount; i++)
+    {
+        packets += mPackets[i];
+    }
+    int pilots = 0;
+    int controllers = 0;
+    for (auto iter = mCallsigns.cbegin(); iter != mCallsigns.cend(); ++iter)
+    {
+        if (iter.value()->IsController())
+        {
+            controllers++;
+        }
+        else
+        {
+            pilots++;
+        }
+    }
+
+    double interval = mIntervalTime.restart() / 1000.0;
+    double runTime = mRunTime.elapsed() / 1000.0;
+    if (interval <= 0.0)
+    {
+        interval = 1.0;
+    }
+    if (runTime <= 0.0)
+    {
+        runTime = 1.0;
+    }
+
+    qDebug() << "---------------------------------------------------------";
+    qDebug() << "-- Run time:      " << runTime << "s";
+    qDebug() << "-- Connections:   " << mConnections << "(max" << mMaxConnections << ")";
+    qDebug() << "-- Logged in:     " << pilots << "pilots," << controllers << "controllers";
+    qDebug() << "-- Ingest:        " << (packets - mLastPackets) / interval << "packets/s,"
+             << (mBytes - mLastBytes) / interval << "bytes/s";
+    qDebug() << "-- Ingest (avg):  " << packets / runTime << "packets/s,"
+             << mBytes / runTime << "bytes/s";
+    if (mFanOut)
+    {
+        qDebug() << "-- Fan-out:       " << (mFanOutPackets - mLastFanOutPackets) / interval << "packets/s,"
+                 << mFanOutPackets << "packets," << mFanOutBytes << "bytes total";
+    }
+    for (int i = 0; i < PacketTypeCount; i++)
+    {
+        qDebug() << "--   " << qPrintable(PacketTypeToString(static_cast<FsdPacketType>(i))) << ":" << mPackets[i];
+    }
+
+    mLastPackets = packets;
+    mLastBytes = mBytes;
+    mLastFanOutPackets = mFanOutPackets;
+}
+
+void FsdServer::incomingConnection(qintptr socketDescriptor)
+{
+    QTcpSocket *socket = new QTcpSocket();
+    if (!socket->setSocketDescriptor(socketDescriptor))
+    {
+        qDebug() << "Error: Cannot accept connection: " << qPrintable(socket->errorString());
+        delete socket;
+        return;
+    }
+    new FsdConnection(socket, this);
+    mConnections++;
+    mMaxConnections = qMax(mMaxConnections, mConnections);
+}
@@ -0,0 +1,111 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FSD_SERVER_H_
+#define FSD_SERVER_H_
+
+#include <QtNetwork>
+
+enum FsdPacketType
+{
+    PilotLogonPacket,
+    AtcLogonPacket,
+    PilotLogoffPacket,
+    AtcLogoffPacket,
+    PilotPositionPacket,
+    AtcPositionPacket,
+    InterimPositionPacket,
+    TextMessagePacket,
+    OtherPacket,
+
+    PacketTypeCount
+};
+
+QString PacketTypeToString(FsdPacketType type);
+
+class FsdServer;
+
+class FsdConnection : public QObject
+{
+    Q_OBJECT
+public:
+    FsdConnection(QTcpSocket *socket, FsdServer *server);
+
+    QByteArray GetCallsign() const;
+    bool IsLoggedIn() const;
+    bool IsController() const;
+    bool HasPosition() const;
+    double GetLat() const;
+    double GetLong() const;
+    int GetRange() const;
+
+    void Send(const QByteArray &Packet);
+
+private slots:
+    void ReadData();
+    void Disconnected();
+
+private:
+    void ProcessPacket(const QByteArray &Packet);
+    void Logon(const QByteArray &Callsign, bool Controller);
+    void Logoff();
+
+    QTcpSocket *mSocket;
+    FsdServer *mServer;
+    QByteArray mBuffer;
+
+    QByteArray mCallsign;
+    bool mIsController;
+    bool mHasPosition;
+    double mLat;
+    double mLong;
+    int mVisRange;
+};
+
+class FsdServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    FsdServer(bool FanOut, int PilotRange, QObject *parent = 0);
+
+    bool RegisterCallsign(const QByteArray &Callsign, FsdConnection *Connection);
+    void UnregisterCallsign(const QByteArray &Callsign);
+
+    void CountPacket(FsdPacketType Type, int Bytes);
+    void FanOutPosition(FsdConnection *Sender, const QByteArray &Packet);
+    void Forward(const QByteArray &Receiver, const QByteArray &Packet);
+    void ConnectionClosed(FsdConnection *Connection);
+
+    int GetPilotRange() const;
+
+    void SetQuitWhenIdle(bool Quit);
+
+public slots:
+    void Report();
+
+protected:
+    virtual void incomingConnection(qintptr socketDescriptor);
+
+private:
+    bool mFanOut;
+    int mPilotRange;
+    bool mQuitWhenIdle;
+
+    QHash<QByteArray, FsdConnection *> mCallsigns;
+    int mConnections;
+    int mMaxConnections;
+
+    QElapsedTimer mRunTime;
+    QElapsedTimer mIntervalTime;
+    quint64 mPackets[PacketTypeCount];
+    quint64 mBytes;
+    quint64 mFanOutPackets;
+    quint64 mFanOutBytes;
+    quint64 mLastPackets;
+    quint64 mLastBytes;
+    quint64 mLastFanOutPackets;
+};
+
+#endif
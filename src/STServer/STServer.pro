@@ -0,0 +1,21 @@
+QT += core network
+QT -= gui
+
+include(../../common.pri)
+
+INCLUDEPATH += . .. ../..
+
+TARGET = STServer
+TEMPLATE = app
+CONFIG += console
+CONFIG += c++14
+
+SOURCES += *.cpp
+HEADERS += *.h
+
+LIBS    += -L$$BuildRoot/lib -lSTLib -lz
+
+DESTDIR = $$BuildRoot/bin
+
+target.path = $$BuildRoot/dist/bin
+INSTALLS += target
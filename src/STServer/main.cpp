@@ -0,0 +1,63 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QCommandLineParser>
+
+#include "FsdServer.h"
+
+#define SERVER_PORT     6809
+#define PILOT_RANGE     40
+#define REPORT_INTERVAL 10
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("trafficsim-server");
+    QCommandLineParser parser;
+    parser.setApplicationDescription("stand-in FSD server to benchmark the traffic simulator locally.");
+    parser.addHelpOption();
+    parser.addOption({{"P", "port"},
+                      QCoreApplication::translate("main", "Listen on <port>"),
+                      QCoreApplication::translate("main", "port"),
+                      QString::number(SERVER_PORT)
+                     });
+    parser.addOption({{"f", "fanout"},
+                      QCoreApplication::translate("main", "Send positions to all clients in range")
+                     });
+    parser.addOption({{"r", "range"},
+                      QCoreApplication::translate("main", "Visibility range of pilots in <nm> for the fan-out"),
+                      QCoreApplication::translate("main", "nm"),
+                      QString::number(PILOT_RANGE)
+                     });
+    parser.addOption({{"i", "interval"},
+                      QCoreApplication::translate("main", "Report throughput every <seconds>"),
+                      QCoreApplication::translate("main", "seconds"),
+                      QString::number(REPORT_INTERVAL)
+                     });
+    parser.addOption({{"q", "quit-when-idle"},
+                      QCoreApplication::translate("main", "Print a final report and quit after the last client disconnected")
+                     });
+
+    parser.process(a);
+
+    int Port = parser.value("port").toInt();
+    FsdServer Server(parser.isSet("fanout"), parser.value("range").toInt());
+    Server.SetQuitWhenIdle(parser.isSet("quit-when-idle"));
+    if (!Server.listen(QHostAddress::Any, Port))
+    {
+        qDebug() << "Error: Cannot listen on port " << Port << ": " << qPrintable(Server.errorString());
+        return 1;
+    }
+
+    qDebug() << "FSD Port:          " << Port;
+    qDebug() << "Fan-out:           " << parser.isSet("fanout");
+    qDebug() << "Pilot range:       " << parser.value("range").toInt() << "nm";
+
+    QTimer ReportTimer;
+    QObject::connect(&ReportTimer, &QTimer::timeout, &Server, &FsdServer::Report);
+    ReportTimer.start(parser.value("interval").toInt() * 1000);
+
+    return a.exec();
+}
@@ -4,18 +4,27 @@
  *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #define _CRT_SECURE_NO_WARNINGS
 
+#include "STLib/PacketSize.h"
 #include "AirplaneClientProcess.h"
+#include "RateLimiter.h"
+#include "SendTrace.h"
+#include "Statistics.h"
+#include "STLib/Geo.h"
 
-AirplaneClientProcess::AirplaneClientProcess(pClient client)
-    : ClientProcess(client)
+// longer gaps are no continuous flight, the airplane was out of range
+#define INTERIM_MAX_GAP 30000
+
+AirplaneClientProcess::AirplaneClientProcess(ClientView view)
+    : ClientProcess(view), mInterimTimer(this), mInterimStart(0), mInterimDuration(0), mInterimSize(0)
 {
-    pAirplane = (Airplane *)client.get();
+    pAirplane = (Airplane *)mClient.get();
+    connect(&mInterimTimer, &DispatchTimer::Timeout, this, &AirplaneClientProcess::SendInterimPosition);
 }
 
 void AirplaneClientProcess::SetLoginInformation()
 {
     VatPilotConnection PilotInfo;
-    std::string callsign = mClient->GetCallsign().toStdString();
+    std::string callsign = mView.GetCallsign().toStdString();
     PilotInfo.callsign = callsign.c_str();
     PilotInfo.name = "Test Client";
     PilotInfo.rating = static_cast<VatPilotRating>(mClient->GetRating());
@@ -25,12 +34,18 @@ void AirplaneClientProcess::SetLoginInformation()
                           Password.toStdString().c_str(), &PilotInfo);
 }
 
-void AirplaneClientProcess::SendPositionInfo(pTimeUpdate Update)
+void AirplaneClientProcess::SendPositionInfo(pTimeUpdate Update, int Step)
 {
     AirplanePositionUpdate *AirPos = (AirplanePositionUpdate *)Update.get();
-    VatPilotPosition Pos = AirPos->GetPosUpdate();
+    VatPilotPosition Pos = AirPos->GetPosUpdate(Step);
+    mView.ApplyOffset(Pos.latitude, Pos.longitude);
 
-    Vat_SendPilotUpdate(mNetwork, &Pos);
+    if (mNetwork != 0)
+    {
+        // the null transport has no session
+        Vat_SendPilotUpdate(mNetwork, &Pos);
+    }
+    StartInterimPositions(Pos, AirPos, Step);
 }
 
 void AirplaneClientProcess::SendPlaneInfoRequest(const char *callsign)
@@ -45,3 +60,91 @@ void AirplaneClientProcess::SendPlaneInfoRequest(const char *callsign)
     aircraftInfo.livery = livery.constData();
     Vat_SendAircraftInfo(mNetwork, callsign, &aircraftInfo);
 }
+
+void AirplaneClientProcess::StartInterimPositions(const VatPilotPosition &Pos, const AirplanePositionUpdate *Update, int Step)
+{
+    mInterimTimer.Stop();
+    if (InterimRate <= 0 || Blast)
+    {
+        return;
+    }
+    const QVector<int> &Steps = Update->GetSteps();
+    if (Step < Steps.size())
+    {
+        // the next position is a thinned one of the same update
+        mInterimDuration = Steps[Step];
+        mInterimTo = Update->GetPosUpdate(Step + 1);
+    }
+    else
+    {
+        pTimeUpdate Next = PeekNextUpdate(PositionAirplaneReason, mInterimDuration);
+        if (Next == 0)
+        {
+            return;
+        }
+        for (int Elapsed : Steps)
+        {
+            mInterimDuration -= Elapsed;
+        }
+        mInterimTo = ((AirplanePositionUpdate *)Next.get())->GetPosUpdate();
+    }
+    if (mInterimDuration <= 0 || mInterimDuration > INTERIM_MAX_GAP)
+    {
+        return;
+    }
+    mInterimFrom = Pos;
+    mInterimSize = EstimatePacketSize(mView.GetCallsign(), Update);
+    mView.ApplyOffset(mInterimTo.latitude, mInterimTo.longitude);
+    mInterimStart = DispatchTimer::Now();
+    mInterimTimer.StartAt(mInterimStart + 1000000000LL / InterimRate);
+}
+
+void AirplaneClientProcess::SendInterimPosition()
+{
+    double fraction = (DispatchTimer::Now() - mInterimStart) / (mInterimDuration * 1e6);
+    if (fraction >= 1.0 || !IsConnected() || Draining)
+    {
+        // the recorded position is due now, the airplane went offline or
+        // waits for its logoff
+        return;
+    }
+    // the next one on the same beat, however late this one is
+    mInterimTimer.StartAt(mInterimTimer.GetDeadline() + 1000000000LL / InterimRate);
+    if (Limiter != 0 && !Limiter->TryAdmit(PositionLimit, mInterimSize))
+    {
+        // an interim position is not worth sending late, the next one
+        // is closer to the truth
+        return;
+    }
+
+    VatPilotPosition Pos = mInterimFrom;
+    GreatCircleInterpolate(mInterimFrom.latitude, mInterimFrom.longitude, mInterimTo.latitude, mInterimTo.longitude,
+                           fraction, Pos.latitude, Pos.longitude);
+    Pos.altitudeTrue = mInterimFrom.altitudeTrue + qRound((mInterimTo.altitudeTrue - mInterimFrom.altitudeTrue) * fraction);
+    Pos.altitudePressure = mInterimFrom.altitudePressure + qRound((mInterimTo.altitudePressure - mInterimFrom.altitudePressure) * fraction);
+    Pos.groundSpeed = mInterimFrom.groundSpeed + qRound((mInterimTo.groundSpeed - mInterimFrom.groundSpeed) * fraction);
+    Pos.heading = InterpolateHeading(mInterimFrom.heading, mInterimTo.heading, fraction);
+    Pos.pitch = mInterimFrom.pitch + (mInterimTo.pitch - mInterimFrom.pitch) * fraction;
+    Pos.bank = mInterimFrom.bank + (mInterimTo.bank - mInterimFrom.bank) * fraction;
+
+    // the null transport has no session
+    if (mNetwork != 0 && InterimReceiver.isEmpty())
+    {
+        Vat_SendPilotUpdate(mNetwork, &Pos);
+    }
+    else if (mNetwork != 0)
+    {
+        VatInterimPilotPosition Interim;
+        Interim.latitude = Pos.latitude;
+        Interim.longitude = Pos.longitude;
+        Interim.altitudeTrue = Pos.altitudeTrue;
+        Interim.groundSpeed = Pos.groundSpeed;
+        Interim.heading = Pos.heading;
+        Interim.bank = Pos.bank;
+        Interim.pitch = Pos.pitch;
+        Interim.onGround = Pos.onGround;
+        Vat_SendInterimPilotUpdate(mNetwork, InterimReceiver.toStdString().c_str(), &Interim);
+    }
+    RunStatistics::Instance().PacketSent();
+    SendTrace::Instance().Record(mView.GetCallsign(), "interim");
+}
@@ -12,16 +12,30 @@ class AirplaneClientProcess : public ClientProcess
 {
     Q_OBJECT
 public:
-    AirplaneClientProcess(pClient client);
+    AirplaneClientProcess(ClientView view);
 
     virtual void SetLoginInformation();
 
 protected:
-    virtual void SendPositionInfo(pTimeUpdate Update);
+    virtual void SendPositionInfo(pTimeUpdate Update, int Step);
     virtual void SendPlaneInfoRequest(const char *callsign);
 
+private slots:
+    void SendInterimPosition();
+
 private:
+    void StartInterimPositions(const VatPilotPosition &Pos, const AirplanePositionUpdate *Update, int Step);
+
     Airplane *pAirplane;
+
+    DispatchTimer mInterimTimer;
+    // ns of DispatchTimer::Now the interim positions start from
+    qint64 mInterimStart;
+    int mInterimDuration;
+    // what the limiter charges for an interim position
+    int mInterimSize;
+    VatPilotPosition mInterimFrom;
+    VatPilotPosition mInterimTo;
 };
 
 #endif
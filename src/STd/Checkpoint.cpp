@@ -0,0 +1,158 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+#include "Checkpoint.h"
+
+namespace
+{
+    const char *Magic = "STd checkpoint 1";
+}
+
+ProgressRecord::ProgressRecord(QString Callsign, int Time)
+    : mCallsign(Callsign)
+{
+    mProgress.Index = 0;
+    mProgress.Time = Time;
+    mProgress.Online = false;
+}
+
+QString ProgressRecord::GetCallsign() const
+{
+    return mCallsign;
+}
+
+ClientProgress ProgressRecord::Get() const
+{
+    QMutexLocker Locker(&mLock);
+    return mProgress;
+}
+
+void ProgressRecord::UpdateDone(int Index, int Time)
+{
+    QMutexLocker Locker(&mLock);
+    mProgress.Index = Index;
+    mProgress.Time = Time;
+}
+
+void ProgressRecord::SetOnline(bool Online)
+{
+    QMutexLocker Locker(&mLock);
+    mProgress.Online = Online;
+}
+
+
+Checkpoint::Checkpoint()
+    : mClients(0), mTime(0)
+{
+}
+
+void Checkpoint::SetScenario(QString Scenario, int Clients)
+{
+    mScenario = Scenario;
+    mClients = Clients;
+}
+
+bool Checkpoint::Matches(QString Scenario, int Clients) const
+{
+    return mScenario == Scenario && mClients == Clients;
+}
+
+void Checkpoint::SetTime(int Time)
+{
+    mTime = Time;
+}
+
+int Checkpoint::GetTime() const
+{
+    return mTime;
+}
+
+void Checkpoint::AddClient(QString Callsign, const ClientProgress &Progress)
+{
+    mProgress.insert(Callsign, Progress);
+}
+
+bool Checkpoint::GetClient(QString Callsign, ClientProgress &Progress) const
+{
+    auto iter = mProgress.find(Callsign);
+    if (iter == mProgress.end())
+    {
+        return false;
+    }
+    Progress = *iter;
+    return true;
+}
+
+bool Checkpoint::Write(QString FileName) const
+{
+    // the old checkpoint stays until the new one is complete
+    QSaveFile File(FileName);
+    if (!File.open(QFile::WriteOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot write checkpoint " << qPrintable(File.errorString());
+        return false;
+    }
+    QTextStream Out(&File);
+    Out << Magic << "\n";
+    Out << "scenario " << mClients << " " << mScenario << "\n";
+    Out << "time " << mTime << "\n";
+    for (auto iter = mProgress.cbegin(); iter != mProgress.cend(); ++iter)
+    {
+        Out << "client " << iter.key() << " " << iter->Index << " " << iter->Time << " " << (iter->Online ? 1 : 0)
+            << "\n";
+    }
+    Out.flush();
+    return File.commit();
+}
+
+bool Checkpoint::Read(QString FileName)
+{
+    QFile File(FileName);
+    if (!File.open(QFile::ReadOnly | QFile::Text))
+    {
+        qDebug() << "Error: Cannot read checkpoint " << qPrintable(File.errorString());
+        return false;
+    }
+    QTextStream In(&File);
+    if (In.readLine() != Magic)
+    {
+        qDebug() << "Error: " << qPrintable(FileName) << " is no checkpoint";
+        return false;
+    }
+    mProgress.clear();
+    while (!In.atEnd())
+    {
+        QString Line = In.readLine();
+        QStringList Fields = Line.split(' ');
+        if (Fields[0] == "scenario" && Fields.size() >= 3)
+        {
+            // the file name may contain spaces
+            mClients = Fields[1].toInt();
+            mScenario = Line.section(' ', 2);
+        }
+        else if (Fields[0] == "time" && Fields.size() == 2)
+        {
+            mTime = Fields[1].toInt();
+        }
+        else if (Fields[0] == "client" && Fields.size() == 5)
+        {
+            ClientProgress Progress;
+            Progress.Index = Fields[2].toInt();
+            Progress.Time = Fields[3].toInt();
+            Progress.Online = Fields[4] == "1";
+            mProgress.insert(Fields[1], Progress);
+        }
+        else if (!Line.isEmpty())
+        {
+            qDebug() << "Error: damaged checkpoint line " << qPrintable(Line);
+            return false;
+        }
+    }
+    return true;
+}
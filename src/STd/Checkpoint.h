@@ -0,0 +1,68 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <memory>
+
+// How far a client has got: the updates before Index are done, the last
+// one at Time ms after the start of the scenario.
+struct ClientProgress
+{
+    int Index;
+    int Time;
+    bool Online;
+};
+
+// Written by the client thread, read by the main thread for a checkpoint.
+// It outlives the client, so a finished client can still be read.
+class ProgressRecord
+{
+public:
+    ProgressRecord(QString Callsign, int Time);
+
+    QString GetCallsign() const;
+    ClientProgress Get() const;
+    void UpdateDone(int Index, int Time);
+    void SetOnline(bool Online);
+
+private:
+    QString mCallsign;
+    mutable QMutex mLock;
+    ClientProgress mProgress;
+};
+
+typedef std::shared_ptr<ProgressRecord> pProgressRecord;
+
+// A few lines a long replay writes now and then, so it can be resumed
+// after a crash at the scenario time of the checkpoint. Clients missing
+// in it were done already.
+class Checkpoint
+{
+public:
+    Checkpoint();
+
+    void SetScenario(QString Scenario, int Clients);
+    bool Matches(QString Scenario, int Clients) const;
+    void SetTime(int Time);
+    int GetTime() const;
+    void AddClient(QString Callsign, const ClientProgress &Progress);
+    bool GetClient(QString Callsign, ClientProgress &Progress) const;
+
+    bool Write(QString FileName) const;
+    bool Read(QString FileName);
+
+private:
+    QString mScenario;
+    int mClients;
+    int mTime;
+    QHash<QString, ClientProgress> mProgress;
+};
+
+#endif
@@ -4,7 +4,34 @@
  *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #define _CRT_SECURE_NO_WARNINGS
 
+#include <atomic>
+#include <cmath>
+#include <random>
+#include "STLib/PacketSize.h"
 #include "ClientProcess.h"
+#include "RateLimiter.h"
+#include "SendTrace.h"
+#include "SessionPool.h"
+#include "Statistics.h"
+#include "helper.h"
+
+namespace
+{
+    // clients started so far, for the phase of the next one
+    std::atomic<unsigned> StartedClients(0);
+
+    // a virtual run would spend most of its time writing these lines
+    bool TraceClients()
+    {
+        return !DispatchTimer::Virtual;
+    }
+
+    bool IsPosition(const pTimeUpdate &Update)
+    {
+        return Update->GetUpdateReason() == PositionAirplaneReason ||
+               Update->GetUpdateReason() == PositionATCReason;
+    }
+}
 
 QString ConvertConnStatusToQString(VatConnectionStatus Status)
 {
@@ -29,64 +56,379 @@ QString ConvertConnStatusToQString(VatConnectionStatus Status)
     return "Unknown";
 }
 
-ClientProcess::ClientProcess(pClient client)
-    : mClient(client), mNetwork(0), mTimer(this), m_connectionStatus(vatStatusDisconnected)
+ClientProcess::ClientProcess(ClientView view)
+    : mView(view), mClient(view.GetClient()), mNetwork(0), mCursor(0), mStep(0), mStepTime(0), mDelay(0),
+      mWaiting(false), mStopping(false), mDuration(0), mLoop(0),
+      mDoneTime(view.GetTimeShift()), mProgress(new ProgressRecord(view.GetCallsign(), view.GetTimeShift())),
+      mResumed(false), mResumeOnline(false), mFinished(false), mReconnectAttempt(0), mReconnectSlot(false), mReconnectAdmitted(false),
+      mTimer(this), mStartTime(0), mDueTime(0), mLateRun(0), mPhaseOffset(0), mAdmitted(false), mEventTimer(this), mReconnectTimer(this), m_connectionStatus(vatStatusDisconnected),
+      mLogoffRequested(false)
 
 {
-    mNetwork = Vat_CreateNetworkSession(vatServerVatsim, "SimTest 1.0", 1, 0, "MSFS", 0xb9ba,
-                                        "727d1efd5cb9f8d2c28372469d922bb4",
-                                        vatCapsAircraftInfo | vatCapsInterminPos);
-    if (mNetwork != 0)
+    // one timer for the next event, so a logon never starts a second chain
+    connect(&mEventTimer, &DispatchTimer::Timeout, this, &ClientProcess::DoNextEvent);
+    connect(&mReconnectTimer, &DispatchTimer::Timeout, this, &ClientProcess::Reconnect);
+    if (LoopPeriod > 0)
+    {
+        mDuration = mClient->GetDuration();
+    }
+    if (Phase == SpreadPhase)
     {
+        // steps of the golden ratio fill the period evenly for any number
+        // of clients
+        double Fraction = std::fmod(StartedClients.fetch_add(1) * 0.6180339887, 1.0);
+        mPhaseOffset = static_cast<int>(Fraction * PhasePeriod);
+    }
+    PushNextUpdate();
+}
+
+bool ClientProcess::LoginToServer()
+{
+    if(m_connectionStatus == vatStatusConnecting || m_connectionStatus == vatStatusConnected)
+    {
+        return true;
+    }
+    if (NullTransport)
+    {
+        SendTrace::Instance().Record(mView.GetCallsign(), "logon");
+        mLogoffRequested = false;
+        NullStatusChange(vatStatusConnecting);
+        NullStatusChange(vatStatusConnected);
+        return true;
+    }
+    if (mNetwork == 0)
+    {
+        // the session comes from the pool and only lives while online
+        mNetwork = SessionPool::Instance().Acquire();
+        if (mNetwork == 0)
+        {
+            return false;
+        }
         Vat_SetStateChangeHandler(mNetwork, &ClientProcess::ConnectionStatusChanged, this);
         Vat_SetServerErrorHandler(mNetwork, &ClientProcess::ErrorReceived, this);
         Vat_SetAircraftInfoRequestHandler(mNetwork, &ClientProcess::PilotInfoRequest, this);
         Vat_SetTextMessageHandler(mNetwork, &ClientProcess::TextMessageReceived, this);
-        PushNextUpdate();
     }
+    this->SetLoginInformation();
+    mLogoffRequested = false;
+    SendTrace::Instance().Record(mView.GetCallsign(), "logon");
+    Vat_Logon(mNetwork);
+    return true;
 }
 
-bool ClientProcess::LoginToServer()
+void ClientProcess::Disconnect()
+{
+    if (mNetwork != 0)
+    {
+        Vat_Logoff(mNetwork);
+    }
+    bool Online = m_connectionStatus == vatStatusConnecting || m_connectionStatus == vatStatusConnected;
+    if (Online)
+    {
+        SendTrace::Instance().Record(mView.GetCallsign(), "logoff");
+    }
+    m_connectionStatus = vatStatusDisconnecting;
+    mLogoffRequested = true;
+    if (NullTransport && Online)
+    {
+        NullStatusChange(vatStatusDisconnected);
+    }
+}
+
+void ClientProcess::NullStatusChange(VatConnectionStatus NewStatus)
+{
+    ConnectionStatusChanged(0, m_connectionStatus, NewStatus, this);
+}
+
+void ClientProcess::DisconnectAndDestroy()
+{
+    Disconnect();
+    Destroy();
+}
+
+void ClientProcess::Destroy()
 {
+    if (mFinished)
+    {
+        return;
+    }
+    mFinished = true;
+    QObject::disconnect(mProcessShimLibConnection);
+    mEventTimer.Stop();
+    mReconnectTimer.Stop();
     if (mNetwork != 0)
     {
-        if(m_connectionStatus == vatStatusConnecting || m_connectionStatus == vatStatusConnected)
+        if (m_connectionStatus == vatStatusDisconnected)
         {
-            return true;
+            SessionPool::Instance().Release(mNetwork);
         }
-        this->SetLoginInformation();
-        Vat_Logon(mNetwork);
+        else
+        {
+            // the logoff may still be under way
+            Vat_DestroyNetworkSession(mNetwork);
+        }
+        mNetwork = nullptr;
+    }
+    emit ClientFinished();
+}
+
+void ClientProcess::ReleaseSession()
+{
+    // the client may be logging on again already
+    if (mNetwork == 0 || m_connectionStatus != vatStatusDisconnected)
+    {
+        return;
+    }
+    SessionPool::Instance().Release(mNetwork);
+    mNetwork = nullptr;
+}
+
+void ClientProcess::ScheduleNextEvent(int Delay)
+{
+    if (Blast)
+    {
+        // the delays of blast mode start now
+        RescheduleEvent(Delay);
+        return;
+    }
+    // a late event does not delay the ones after it
+    mDueTime += Delay;
+    StartEventTimer();
+}
+
+void ClientProcess::RescheduleEvent(int Delay)
+{
+    // a deferred event is admitted again on its new schedule
+    mAdmitted = false;
+    mDueTime = Elapsed() + Delay;
+    StartEventTimer();
+}
+
+void ClientProcess::StartEventTimer()
+{
+    qint64 FireTime = mDueTime;
+    if (!Blast && Phase != NaturalPhase && IsPosition(mNextUpdate))
+    {
+        // the beats are on the clock of the timers, which all clients share;
+        // the schedule after the position stays where the log has it
+        qint64 Absolute = mStartTime / 1000000 + mDueTime - mPhaseOffset;
+        // the virtual clock starts at 0, so Absolute may be negative
+        qint64 Beat = (Absolute % PhasePeriod + PhasePeriod) % PhasePeriod;
+        FireTime += (PhasePeriod - Beat) % PhasePeriod;
+    }
+    // the deadline is absolute, so the time spent here does not add up
+    mEventTimer.StartAt(mStartTime + FireTime * 1000000);
+}
+
+qint64 ClientProcess::Elapsed() const
+{
+    return (DispatchTimer::Now() - mStartTime) / 1000000;
+}
+
+bool ClientProcess::SkipStalePosition()
+{
+    if (Blast || CatchUp == SendAllPolicy)
+    {
+        return false;
+    }
+    int Next = TimeToNextPosition();
+    if (Next < 0 || Elapsed() - mDueTime < Next)
+    {
+        mLateRun = 0;
+        return false;
+    }
+    // the next position is due already, this one tells the server nothing
+    if (CatchUp == BurstPolicy && mLateRun < BurstLimit)
+    {
+        mLateRun++;
+        return false;
+    }
+    return true;
+}
+
+bool ClientProcess::AdmitEvent(const pTimeUpdate &Update)
+{
+    if (Limiter == 0 || mAdmitted)
+    {
+        mAdmitted = false;
         return true;
     }
+    LimitClass Class = OtherLimit;
+    switch (Update->GetUpdateReason())
+    {
+    case PositionAirplaneReason:
+    case PositionATCReason:
+        Class = PositionLimit;
+        break;
+    case TextMsg:
+        Class = TextLimit;
+        break;
+    default:
+        break;
+    }
+    int Wait = Limiter->Admit(Class, EstimatePacketSize(mView.GetCallsign(), Update.get()));
+    if (Wait == 0)
+    {
+        return true;
+    }
+    // over the budget the event goes out later, the schedule after it
+    // stays as it is
+    mAdmitted = true;
+    mEventTimer.Start(Wait);
     return false;
 }
 
-void ClientProcess::Disconnect()
+bool ClientProcess::AdmitLogon(bool &Admitted, DispatchTimer &Timer)
 {
-    Vat_Logoff(mNetwork);
-    m_connectionStatus = vatStatusDisconnecting;
+    if (Limiter == 0 || Admitted)
+    {
+        Admitted = false;
+        return true;
+    }
+    // a reconnect burst is made of the largest packets
+    int Wait = Limiter->Admit(OtherLimit, LogonPacketSize + mView.GetCallsign().size());
+    if (Wait == 0)
+    {
+        return true;
+    }
+    Admitted = true;
+    Timer.Start(Wait);
+    return false;
 }
 
-void ClientProcess::DisconnectAndDestroy()
+int ClientProcess::TimeToNextPosition() const
 {
-    QObject::disconnect(mProcessShimLibConnection);
-    Disconnect();
-    Vat_DestroyNetworkSession(mNetwork);
-    mNetwork = nullptr;
-    emit ClientFinished();
+    if (mNextUpdate->GetUpdateReason() == PositionAirplaneReason)
+    {
+        const QVector<int> &Steps = static_cast<AirplanePositionUpdate *>(mNextUpdate.get())->GetSteps();
+        if (mStep < Steps.size())
+        {
+            return Steps[mStep];
+        }
+    }
+    int TimeToUpdate;
+    if (PeekNextUpdate(mNextUpdate->GetUpdateReason(), TimeToUpdate) == 0)
+    {
+        return -1;
+    }
+    // the steps sent so far are part of the time difference
+    return TimeToUpdate - mStepTime;
+}
+
+void ClientProcess::ScheduleReconnect()
+{
+    static thread_local std::mt19937 Random(std::random_device{}());
+    // half the backoff is fixed, the other half random, so the clients the
+    // server dropped together spread out
+    int Backoff = static_cast<int>(qMin<qint64>(ReconnectMax, static_cast<qint64>(ReconnectBase) << qMin(mReconnectAttempt, 16)));
+    int Delay = Backoff / 2 + std::uniform_int_distribution<int>(0, Backoff - Backoff / 2)(Random);
+    mReconnectAttempt++;
+    mReconnectSlot = false;
+    mReconnectAdmitted = false;
+    mReconnectTimer.Start(Delay);
+}
+
+void ClientProcess::Reconnect()
+{
+    if (mFinished || mStopping || Draining || m_connectionStatus == vatStatusConnecting || m_connectionStatus == vatStatusConnected)
+    {
+        return;
+    }
+    if (!mReconnectSlot && ReconnectPacer != 0)
+    {
+        mReconnectSlot = true;
+        int Wait = ReconnectPacer->Reserve();
+        if (Wait > 0)
+        {
+            mReconnectTimer.Start(Wait);
+            return;
+        }
+    }
+    if (!AdmitLogon(mReconnectAdmitted, mReconnectTimer))
+    {
+        return;
+    }
+    mReconnectSlot = false;
+    RunStatistics::Instance().Reconnecting();
+    if (!LoginToServer())
+    {
+        ScheduleReconnect();
+    }
+}
+
+void ClientProcess::Stop()
+{
+    if (mStopping || mFinished)
+    {
+        return;
+    }
+    mStopping = true;
+    if (m_connectionStatus == vatStatusConnected)
+    {
+        // the session lives on until the logoff is sent and confirmed
+        Disconnect();
+        ProcessShimLib();
+    }
+    else
+    {
+        DisconnectAndDestroy();
+    }
 }
 
 void ClientProcess::Run()
 {
-    if (mNetwork == 0)
+    if (mNextUpdate == 0)
     {
+        mFinished = true;
         emit ClientFinished();
         return;
     }
     //qDebug() << "Next Update in " << mNextUpdate->GetTimeDiff();
-    QTimer::singleShot(mNextUpdate->GetTimeDiff(), this, SLOT(DoNextEvent()));
-    mProcessShimLibConnection = QObject::connect(&mTimer, &QTimer::timeout, this, &ClientProcess::ProcessShimLib);
-    mTimer.start(100);
+    int delay = NextDelay();
+    if (!Blast && !mResumed)
+    {
+        delay += mView.GetTimeShift();
+    }
+    mStartTime = DispatchTimer::Now();
+    if (mResumeOnline)
+    {
+        // the next event follows the logon, as for an offline client
+        LoginToServer();
+    }
+    else
+    {
+        RescheduleEvent(delay);
+    }
+    if (!NullTransport)
+    {
+        mProcessShimLibConnection = QObject::connect(&mTimer, &QTimer::timeout, this, &ClientProcess::ProcessShimLib);
+        mTimer.start(100);
+    }
+}
+
+bool ClientProcess::Resume(const ClientProgress &Progress, int ScenarioTime)
+{
+    // takes the cursor over, the updates before it are not looked at
+    if (Progress.Index < 0 || Progress.Index >= mClient->GetTimeUpdateContainer()->size())
+    {
+        return false;
+    }
+    mCursor = Progress.Index;
+    mDoneTime = Progress.Time;
+    mNextUpdate = 0;
+    mStep = 0;
+    mStepTime = 0;
+    PushNextUpdate();
+    mDelay = qMax(0, mDoneTime + mNextUpdate->GetTimeDiff() - ScenarioTime);
+    mProgress->UpdateDone(mCursor - 1, mDoneTime);
+    mResumed = true;
+    mResumeOnline = Progress.Online;
+    return true;
+}
+
+pProgressRecord ClientProcess::GetProgressRecord() const
+{
+    return mProgress;
 }
 
 void ClientProcess::SendPlaneInfoRequest(const char * /* callsign */)
@@ -97,17 +439,39 @@ void ClientProcess::SendPlaneInfoRequest(const char * /* callsign */)
 void ClientProcess::SendTextMsg(pTimeUpdate Update)
 {
     TextMessageUpdate *text = (TextMessageUpdate *)Update.get();
-    Vat_SendTextMessage(mNetwork, text->GetReceiver().toStdString().c_str(), text->GetMessage().toStdString().c_str());
+    if (mNetwork == 0)
+    {
+        // the null transport has no session
+        return;
+    }
+    QString Receiver = mView.MapCallsign(text->GetReceiver());
+    Vat_SendTextMessage(mNetwork, Receiver.toStdString().c_str(), text->GetMessage().toStdString().c_str());
 }
 
 void ClientProcess::DoNextEvent()
 {
+    if (mStopping || mFinished || Draining)
+    {
+        return;
+    }
     pTimeUpdate UpdateTask = mNextUpdate;
 
     // do stuff with UpdateTask:
-    qDebug() << qPrintable(mClient->GetCallsign()) << ": " << qPrintable(UpdateReasonToString(UpdateTask->GetUpdateReason()));
+    if (!Blast && TraceClients())
+    {
+        qDebug() << qPrintable(mView.GetCallsign()) << ": " << qPrintable(UpdateReasonToString(UpdateTask->GetUpdateReason()));
+    }
     if(m_connectionStatus != vatStatusConnecting && m_connectionStatus != vatStatusConnected)
     {
+        if (mReconnectTimer.IsActive())
+        {
+            // the reconnect sends this event once the client is back
+            return;
+        }
+        if (!AdmitLogon(mAdmitted, mEventTimer))
+        {
+            return;
+        }
         if (!LoginToServer())
         {
             DisconnectAndDestroy();
@@ -115,80 +479,268 @@ void ClientProcess::DoNextEvent()
         }
         return;
     }
-    if (UpdateTask->GetUpdateReason() == PositionAirplaneReason || UpdateTask->GetUpdateReason() == PositionATCReason)
+    bool Position = IsPosition(UpdateTask);
+    // a deferred position was not stale when it was admitted
+    if (Position && !mAdmitted && SkipStalePosition())
     {
-        SendPositionInfo(UpdateTask);
+        RunStatistics::Instance().PositionDropped();
+    }
+    else if (Position)
+    {
+        if (!AdmitEvent(UpdateTask))
+        {
+            return;
+        }
+        SendPositionInfo(UpdateTask, mStep);
+        RunStatistics::Instance().PacketSent();
+        SendTrace::Instance().Record(mView.GetCallsign(), "position");
     }
     else if (UpdateTask->GetUpdateReason() == TextMsg)
     {
+        if (!AdmitEvent(UpdateTask))
+        {
+            return;
+        }
         SendTextMsg(UpdateTask);
+        RunStatistics::Instance().PacketSent();
+        SendTrace::Instance().Record(mView.GetCallsign(), "text");
     }
     else if (UpdateTask->GetUpdateReason() == RemoveAirplaneReason || UpdateTask->GetUpdateReason() == RemoveATCReason)
     {
+        if (!AdmitEvent(UpdateTask))
+        {
+            return;
+        }
         Disconnect();
+        RunStatistics::Instance().PacketSent();
+    }
+    if (Blast)
+    {
+        // there is no idle time between the events, so flush right away
+        ProcessShimLib();
     }
 
     PushNextUpdate();
+    if (mNextUpdate == 0 && LoopPeriod > 0)
+    {
+        StartNextLoop();
+    }
     if (mNextUpdate == 0)
     {
-        DisconnectAndDestroy();
-        qDebug() << "closing";
+        EndOfUpdates();
     }
     else
     {
         // load Timer for next shot:
-        int delta = mNextUpdate->GetTimeDiff();
-        QTimer::singleShot(delta, this, SLOT(DoNextEvent()));
+        ScheduleNextEvent(NextDelay());
+    }
+}
+
+void ClientProcess::AppendUpdate(pTimeUpdate Update, int Delay)
+{
+    if (mStopping || Draining)
+    {
+        return;
+    }
+    mClient->AddTimeUpdate(Update);
+    if (!mWaiting || mFinished)
+    {
+        // the running chain of delays reaches it by its time difference
+        return;
+    }
+    mWaiting = false;
+    PushNextUpdate();
+    mDelay = Delay;
+    RescheduleEvent(NextDelay());
+}
+
+void ClientProcess::EndOfUpdates()
+{
+    if (Live)
+    {
+        mWaiting = true;
+        return;
+    }
+    DisconnectAndDestroy();
+    if (TraceClients())
+    {
+        qDebug() << "closing";
+    }
+}
+
+void ClientProcess::StartNextLoop()
+{
+    // the same updates again, shifted by one period
+    mLoop++;
+    // the trailing logoff may be trimmed from the log, a session left
+    // silent until the next loop would be timed out by the server. The
+    // first event of the next loop logs on again, as in a single run
+    if (IsConnected())
+    {
+        Disconnect();
+    }
+    if (LoopRotation > 1)
+    {
+        mView.SetRotation(mLoop % LoopRotation);
+    }
+    mCursor = 0;
+    PushNextUpdate();
+    if (mNextUpdate != 0)
+    {
+        mDelay += LoopPeriod - mDuration;
     }
 }
 
 void ClientProcess::ProcessShimLib()
 {
-    Vat_ExecuteNetworkTasks(mNetwork);
+    if (mNetwork != 0)
+    {
+        Vat_ExecuteNetworkTasks(mNetwork);
+    }
 }
 
 void ClientProcess::PushNextUpdate()
 {
-    QList<pTimeUpdate> *List = mClient->GetTimeUpdateContainer();
-    if (List->size() == 0)
+    // positions left out by the thinning are sent before the next update,
+    // whose time difference already covers them
+    if (mNextUpdate != 0 && mNextUpdate->GetUpdateReason() == PositionAirplaneReason)
+    {
+        const QVector<int> &Steps = static_cast<AirplanePositionUpdate *>(mNextUpdate.get())->GetSteps();
+        if (mStep < Steps.size())
+        {
+            mDelay = Steps[mStep];
+            mStepTime += mDelay;
+            mStep++;
+            return;
+        }
+    }
+    mStep = 0;
+
+    // the time updates are shared by all copies of the client, so only
+    // move the cursor instead of taking them out of the list. A live
+    // client owns its list and forgets what it has sent, it keeps growing
+    if (Live && mCursor > 0)
+    {
+        TimeUpdateContainer *Own = mClient->GetTimeUpdateContainer();
+        Own->erase(Own->begin(), Own->begin() + mCursor);
+        mCursor = 0;
+    }
+    if (mNextUpdate != 0)
+    {
+        mDoneTime += mNextUpdate->GetTimeDiff();
+        mProgress->UpdateDone(mCursor, mDoneTime);
+    }
+    const TimeUpdateContainer *List = mClient->GetTimeUpdateContainer();
+    if (mCursor >= List->size())
     {
         mNextUpdate = 0;
     }
     else
     {
-        mNextUpdate = List->first();
-        List->pop_front();
+        mNextUpdate = List->at(mCursor);
+        mCursor++;
+        mDelay = mNextUpdate->GetTimeDiff() - mStepTime;
+    }
+    mStepTime = 0;
+}
+
+bool ClientProcess::IsConnected() const
+{
+    return (mNetwork != 0 || NullTransport) && m_connectionStatus == vatStatusConnected;
+}
+
+pTimeUpdate ClientProcess::PeekNextUpdate(UpdateReason Reason, int &TimeToUpdate) const
+{
+    // looks ahead from the current event, stops at the next logoff
+    const TimeUpdateContainer *List = mClient->GetTimeUpdateContainer();
+    TimeToUpdate = 0;
+    for (int i = mCursor; i < List->size(); i++)
+    {
+        pTimeUpdate Update = List->at(i);
+        TimeToUpdate += Update->GetTimeDiff();
+        if (Update->GetUpdateReason() == Reason)
+        {
+            return Update;
+        }
+        if (Update->GetUpdateReason() == RemoveAirplaneReason || Update->GetUpdateReason() == RemoveATCReason)
+        {
+            break;
+        }
+    }
+    return pTimeUpdate();
+}
+
+int ClientProcess::NextDelay()
+{
+    if (!Blast)
+    {
+        return mDelay;
     }
+    // blast mode ignores the recorded timing, the order of the events is kept
+    if (Pacer != 0)
+    {
+        return Pacer->Reserve();
+    }
+    return 0;
 }
 
 void ClientProcess::ConnectionStatusChanged(VatFsdClient */* obj */ , VatConnectionStatus oldStatus, VatConnectionStatus newStatus, void *cbVar)
 {
     ClientProcess *client = static_cast<ClientProcess *>(cbVar);
-    qDebug() << "ConnectionStatusChanged: (" << qPrintable(client->mClient->GetCallsign()) << ")";
-    qDebug() << "    old: " << ConvertConnStatusToQString(oldStatus);
-    qDebug() << "    new: " << ConvertConnStatusToQString(newStatus);
+    if (TraceClients())
+    {
+        qDebug() << "ConnectionStatusChanged: (" << qPrintable(client->mView.GetCallsign()) << ")";
+        qDebug() << "    old: " << ConvertConnStatusToQString(oldStatus);
+        qDebug() << "    new: " << ConvertConnStatusToQString(newStatus);
+    }
     if (newStatus == vatStatusConnected)
     {
+        RunStatistics::Instance().LoggedOn();
+        client->mReconnectAttempt = 0;
         if (client->mNextUpdate == 0)
         {
             // there is no next Event, so disconnect:
-            client->DisconnectAndDestroy();
-            qDebug() << "closing";
+            client->m_connectionStatus = newStatus;
+            client->EndOfUpdates();
             return;
         }
-        QTimer::singleShot(client->mNextUpdate->GetTimeDiff(), client, SLOT(DoNextEvent()));
+        if (!client->mEventTimer.IsActive())
+        {
+            // the event the logon was started for, after a reconnect the
+            // chain of events may still be running
+            client->RescheduleEvent(client->NextDelay());
+        }
     }
     if (newStatus == vatStatusDisconnected)
     {
-        // close it
+        if (client->mStopping)
+        {
+            // not from within the callback of the session
+            QMetaObject::invokeMethod(client, "Destroy", Qt::QueuedConnection);
+        }
+        else if (!client->mLogoffRequested)
+        {
+            // not requested by us, so the server dropped the connection
+            RunStatistics::Instance().Disconnected();
+            if (ReconnectBase > 0)
+            {
+                client->ScheduleReconnect();
+            }
+        }
+        else
+        {
+            QMetaObject::invokeMethod(client, "ReleaseSession", Qt::QueuedConnection);
+        }
     }
     client->m_connectionStatus = newStatus;
+    client->mProgress->SetOnline(newStatus == vatStatusConnected);
 }
 
 void ClientProcess::ErrorReceived(VatFsdClient */* obj */ , VatServerError errorType, const char *message, const char *errorData, void *cbVar)
 {
     ClientProcess *client = static_cast<ClientProcess *>(cbVar);
-    qDebug() << "ErrorReceived: (" << qPrintable(client->mClient->GetCallsign()) << ")";
+    RunStatistics::Instance().ErrorReceived();
+    qDebug() << "ErrorReceived: (" << qPrintable(client->mView.GetCallsign()) << ")";
     qDebug() << "    type:      " << errorType;
     qDebug() << "    message:   " << message;
     qDebug() << "    errorData: " << errorData;
@@ -197,7 +749,7 @@ void ClientProcess::ErrorReceived(VatFsdClient */* obj */ , VatServerError error
 void ClientProcess::PilotInfoRequest(VatFsdClient */* obj */ , const char *callsign, void *cbVar)
 {
     ClientProcess *client = static_cast<ClientProcess *>(cbVar);
-    qDebug() << "PilotInfoRequest: (" << qPrintable(client->mClient->GetCallsign()) << ")";
+    qDebug() << "PilotInfoRequest: (" << qPrintable(client->mView.GetCallsign()) << ")";
     qDebug() << "    from:      " << callsign;
     client->SendPlaneInfoRequest(callsign);
 }
@@ -205,7 +757,7 @@ void ClientProcess::PilotInfoRequest(VatFsdClient */* obj */ , const char *calls
 void ClientProcess::TextMessageReceived(VatFsdClient *session, const char *from, const char *to, const char *message, void *cbVar)
 {
     ClientProcess *client = static_cast<ClientProcess *>(cbVar);
-    if (to == client->mClient->GetCallsign())
+    if (to == client->mView.GetCallsign())
     {
         QString returnMessage = "I got this Message from you: ";
         returnMessage += message;
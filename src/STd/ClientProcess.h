@@ -6,43 +6,142 @@
 #ifndef CLIENT_PROCESS_H_
 #define CLIENT_PROCESS_H_
 
-#include "STLib/Client.h"
+#include <atomic>
+#include "STLib/ClientView.h"
+#include "Checkpoint.h"
+#include "DispatchTimer.h"
+
+class PacketPacer;
+class RateLimiter;
+
+// what a client that is behind its schedule does with positions whose
+// successor is due already
+enum CatchUpPolicy
+{
+    SendAllPolicy,
+    LatestPolicy,
+    BurstPolicy,
+};
+
+// when the clients send their positions
+enum PhaseMode
+{
+    // as in the log
+    NaturalPhase,
+    // all on the same beat, in bursts
+    AlignedPhase,
+    // every client on a beat of its own, evenly over the period
+    SpreadPhase,
+};
 
 class ClientProcess : public QObject
 {
     Q_OBJECT
 public:
-    ClientProcess(pClient client);
+    ClientProcess(ClientView view);
     virtual void SetLoginInformation() = 0;
+    // continues from a checkpoint taken at ScenarioTime, before Run, false
+    // if the client has nothing left to do
+    bool Resume(const ClientProgress &Progress, int ScenarioTime);
+    pProgressRecord GetProgressRecord() const;
 
     static QString Server;
     static qint16 Port;
     static QString Username;
     static QString Password;
+    static bool Blast;
+    static PacketPacer *Pacer;
+    static int InterimRate;
+    static QString InterimReceiver;
+    // the client waits for more updates at the end of its list instead of
+    // logging off, for a log that is still written
+    static bool Live;
+    // soak test, the timeline starts over every LoopPeriod ms, 0 to end
+    // after one run
+    static int LoopPeriod;
+    // number of callsigns a client goes through from loop to loop
+    static int LoopRotation;
+    // a client the server dropped logs on again after a random part of a
+    // backoff that starts at ReconnectBase ms and doubles up to
+    // ReconnectMax, at most at the rate of the ReconnectPacer for all
+    static int ReconnectBase;
+    static int ReconnectMax;
+    static PacketPacer *ReconnectPacer;
+    static CatchUpPolicy CatchUp;
+    // stale positions a client still sends in a row with the BurstPolicy
+    static int BurstLimit;
+    // the packet budget of all clients, 0 for none
+    static RateLimiter *Limiter;
+    // positions wait for the next beat of PhasePeriod ms unless the phase
+    // is natural
+    static PhaseMode Phase;
+    static int PhasePeriod;
+    // no server, logons and logoffs are confirmed right away and packets
+    // go nowhere, for engine tests
+    static bool NullTransport;
+    // set once the run is stopped, no client sends or logs on any more
+    // while the logoffs go out a few at a time
+    static std::atomic<bool> Draining;
 
 signals:
     void ClientFinished();
 
 public slots:
     void Run();
+    // Delay is the time to the update if the client waits already
+    void AppendUpdate(pTimeUpdate Update, int Delay);
+    // sends no more events, logs off and finishes once the server has
+    // confirmed it
+    void Stop();
 
 protected:
-    virtual void SendPositionInfo(pTimeUpdate Update) = 0;
+    // Step is the thinned position to send, 0 for the update itself
+    virtual void SendPositionInfo(pTimeUpdate Update, int Step) = 0;
     virtual void SendPlaneInfoRequest(const char *callsign);
     void SendTextMsg(pTimeUpdate Update);
+    pTimeUpdate PeekNextUpdate(UpdateReason Reason, int &TimeToUpdate) const;
+    bool IsConnected() const;
 
+    ClientView mView;
     pClient mClient;
     VatFsdClient *mNetwork;
 
 private slots:
     void DoNextEvent();
     void ProcessShimLib();
+    void Destroy();
+    void Reconnect();
+    // gives the session back to the pool once the client is logged off
+    void ReleaseSession();
 
 private:
     bool LoginToServer();
     void Disconnect();
     void DisconnectAndDestroy();
     void PushNextUpdate();
+    int NextDelay();
+    // Delay after the time the last event was due
+    void ScheduleNextEvent(int Delay);
+    // Delay from now on, the schedule starts over
+    void RescheduleEvent(int Delay);
+    // for mDueTime, moved onto the beat of the client for positions
+    void StartEventTimer();
+    void ScheduleReconnect();
+    // ms since Run
+    qint64 Elapsed() const;
+    // what the server would report, for the null transport
+    void NullStatusChange(VatConnectionStatus NewStatus);
+    // a late position that the catch up policy leaves out
+    bool SkipStalePosition();
+    // false if the limiter defers the event, its timer is set again
+    bool AdmitEvent(const pTimeUpdate &Update);
+    // the same for a logon, which Timer tries again
+    bool AdmitLogon(bool &Admitted, DispatchTimer &Timer);
+    // -1 if no position follows before the logoff
+    int TimeToNextPosition() const;
+    // at the end of the list, logs off or waits for AppendUpdate
+    void EndOfUpdates();
+    void StartNextLoop();
 
     static void ConnectionStatusChanged(VatFsdClient *session, VatConnectionStatus oldStatus, VatConnectionStatus newStatus, void *cbVar);
     static void ErrorReceived(VatFsdClient *session, VatServerError errorType, const char *message, const char *errorData, void *cbVar);
@@ -50,9 +149,43 @@ private:
     static void TextMessageReceived(VatFsdClient *session, const char *from, const char *to, const char *message, void *cbVar);
 
     pTimeUpdate mNextUpdate;
+    int mCursor;
+    int mStep;
+    int mStepTime;
+    int mDelay;
+    bool mWaiting;
+    bool mStopping;
+    int mDuration;
+    int mLoop;
+    // time of the last update done, from the start of the scenario
+    int mDoneTime;
+    pProgressRecord mProgress;
+    bool mResumed;
+    bool mResumeOnline;
+    bool mFinished;
+    int mReconnectAttempt;
+    // the slot of the reconnect rate is taken, the logon is next
+    bool mReconnectSlot;
+    // the limiter let the logon of the reconnect through already
+    bool mReconnectAdmitted;
     QTimer mTimer;
+    // when Run started, in ns of DispatchTimer::Now
+    qint64 mStartTime;
+    // when the next event is due, in ms after mStartTime
+    qint64 mDueTime;
+    // stale positions sent in a row
+    int mLateRun;
+    // ms the beat of the client is after the common one
+    int mPhaseOffset;
+    // the limiter let the deferred event through already
+    bool mAdmitted;
+    DispatchTimer mEventTimer;
+    DispatchTimer mReconnectTimer;
     VatConnectionStatus m_connectionStatus;
+    bool mLogoffRequested;
     QMetaObject::Connection mProcessShimLibConnection;
 };
 
+Q_DECLARE_METATYPE(pTimeUpdate)
+
 #endif
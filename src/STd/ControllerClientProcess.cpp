@@ -5,16 +5,16 @@
 
 #include "ControllerClientProcess.h"
 
-ControllerClientProcess::ControllerClientProcess(pClient client)
-    : ClientProcess(client)
+ControllerClientProcess::ControllerClientProcess(ClientView view)
+    : ClientProcess(view)
 {
-    pController = (Controller *)client.get();
+    pController = (Controller *)mClient.get();
 }
 
 void ControllerClientProcess::SetLoginInformation()
 {
     VatAtcConnection ControllerInfo;
-    std::string callsign = mClient->GetCallsign().toStdString();
+    std::string callsign = mView.GetCallsign().toStdString();
     ControllerInfo.callsign = callsign.c_str();
     ControllerInfo.name = "Controller Name";
     ControllerInfo.rating = static_cast<VatAtcRating>(mClient->GetRating());
@@ -23,9 +23,14 @@ void ControllerClientProcess::SetLoginInformation()
                         Password.toStdString().c_str(), &ControllerInfo);
 }
 
-void ControllerClientProcess::SendPositionInfo(pTimeUpdate Update)
+void ControllerClientProcess::SendPositionInfo(pTimeUpdate Update, int /* Step */)
 {
     ControllerPositionUpdate *ATCPos = (ControllerPositionUpdate *)Update.get();
     VatAtcPosition ATCUpdate = ATCPos->GetPosUpdate();
-    Vat_SendATCUpdate(mNetwork, &ATCUpdate);
+    mView.ApplyOffset(ATCUpdate.latitude, ATCUpdate.longitude);
+    if (mNetwork != 0)
+    {
+        // the null transport has no session
+        Vat_SendATCUpdate(mNetwork, &ATCUpdate);
+    }
 }
@@ -12,12 +12,12 @@ class ControllerClientProcess : public ClientProcess
 {
     Q_OBJECT
 public:
-    ControllerClientProcess(pClient client);
+    ControllerClientProcess(ClientView view);
 
     virtual void SetLoginInformation();
 
 protected:
-    virtual void SendPositionInfo(pTimeUpdate Update);
+    virtual void SendPositionInfo(pTimeUpdate Update, int Step);
 
 private:
     Controller *pController;
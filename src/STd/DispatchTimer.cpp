@@ -0,0 +1,172 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include <QSocketNotifier>
+#include <chrono>
+#include "DispatchTimer.h"
+#include "Statistics.h"
+#include "VirtualClock.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const qint64 NsPerMs = 1000000;
+}
+
+DispatchTimer::DispatchTimer(QObject *parent)
+    : QObject(parent), mTimer(this), mFd(-1), mNotifier(0), mDeadline(0), mActive(false)
+{
+    mTimer.setSingleShot(true);
+    connect(&mTimer, &QTimer::timeout, this, &DispatchTimer::Expired);
+    if (!Precise || Virtual)
+    {
+        return;
+    }
+    mTimer.setTimerType(Qt::PreciseTimer);
+#ifdef Q_OS_LINUX
+    mFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (mFd < 0)
+    {
+        // most likely out of file handles, the precise QTimer still works
+        static bool Warned = false;
+        if (!Warned)
+        {
+            Warned = true;
+            qDebug() << "Warning: no timerfd, falling back to QTimer";
+        }
+        return;
+    }
+    mNotifier = new QSocketNotifier(mFd, QSocketNotifier::Read, this);
+    connect(mNotifier, &QSocketNotifier::activated, this, &DispatchTimer::Expired);
+#endif
+}
+
+DispatchTimer::~DispatchTimer()
+{
+    if (Virtual)
+    {
+        VirtualClock::Instance().Cancel(this);
+    }
+#ifdef Q_OS_LINUX
+    if (mFd >= 0)
+    {
+        delete mNotifier;
+        close(mFd);
+    }
+#endif
+}
+
+void DispatchTimer::StartAt(qint64 Deadline)
+{
+    mDeadline = Deadline;
+    mActive = true;
+    if (Virtual)
+    {
+        VirtualClock::Instance().Schedule(this, Deadline);
+        return;
+    }
+#ifdef Q_OS_LINUX
+    if (mFd >= 0)
+    {
+        // wakes up early by the spin window, a deadline that is past
+        // expires right away
+        qint64 WakeUp = Deadline - SpinWindow * 1000LL;
+        itimerspec Spec = {};
+        Spec.it_value.tv_sec = WakeUp / 1000000000;
+        Spec.it_value.tv_nsec = WakeUp % 1000000000;
+        timerfd_settime(mFd, TFD_TIMER_ABSTIME, &Spec, 0);
+        return;
+    }
+#endif
+    qint64 Wait = Deadline - Now();
+    mTimer.start(static_cast<int>(qMax((Wait + NsPerMs - 1) / NsPerMs, qint64(0))));
+}
+
+void DispatchTimer::Start(int Delay)
+{
+    StartAt(Now() + Delay * NsPerMs);
+}
+
+void DispatchTimer::Stop()
+{
+    mActive = false;
+    mTimer.stop();
+    if (Virtual)
+    {
+        VirtualClock::Instance().Cancel(this);
+    }
+#ifdef Q_OS_LINUX
+    if (mFd >= 0)
+    {
+        itimerspec Spec = {};
+        timerfd_settime(mFd, 0, &Spec, 0);
+    }
+#endif
+}
+
+bool DispatchTimer::IsActive() const
+{
+    return mActive;
+}
+
+qint64 DispatchTimer::GetDeadline() const
+{
+    return mDeadline;
+}
+
+qint64 DispatchTimer::Now()
+{
+    if (Virtual)
+    {
+        return VirtualClock::Instance().Now();
+    }
+#ifdef Q_OS_LINUX
+    timespec Time;
+    clock_gettime(CLOCK_MONOTONIC, &Time);
+    return Time.tv_sec * 1000000000LL + Time.tv_nsec;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void DispatchTimer::Expired()
+{
+#ifdef Q_OS_LINUX
+    if (mFd >= 0)
+    {
+        // nothing to read if the timer was set again since it expired
+        quint64 Expirations;
+        if (read(mFd, &Expirations, sizeof(Expirations)) != sizeof(Expirations))
+        {
+            return;
+        }
+    }
+#endif
+    if (!mActive)
+    {
+        return;
+    }
+    if (mFd >= 0)
+    {
+        while (Now() < mDeadline)
+        {
+            // the spin window, the thread has nothing else to do until then
+        }
+    }
+    mActive = false;
+    if (!Virtual)
+    {
+        // simulated timers are never late
+        RunStatistics::Instance().EventDispatched(Now() - mDeadline);
+    }
+    emit Timeout();
+}
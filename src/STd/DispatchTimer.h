@@ -0,0 +1,55 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DISPATCH_TIMER_H_
+#define DISPATCH_TIMER_H_
+
+#include <QTimer>
+
+class QSocketNotifier;
+
+// The single shot timer of the next event of a client, with deadlines in
+// ns of the monotonic clock. The coarse backend is a QTimer. The precise
+// one is a timerfd with an absolute deadline on Linux, which may busy
+// poll for the last SpinWindow us. Elsewhere it is a precise QTimer.
+// Every timeout reports how late it was to the statistics. With Virtual
+// set, all timers run on the VirtualClock instead.
+class DispatchTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DispatchTimer(QObject *parent);
+    ~DispatchTimer();
+
+    void StartAt(qint64 Deadline);
+    void Start(int Delay);
+    void Stop();
+    bool IsActive() const;
+    qint64 GetDeadline() const;
+
+    // ns of the monotonic clock, or of the virtual one
+    static qint64 Now();
+
+    static bool Precise;
+    static int SpinWindow;
+    static bool Virtual;
+
+signals:
+    void Timeout();
+
+private slots:
+    void Expired();
+
+private:
+    friend class VirtualClock;
+
+    QTimer mTimer;
+    int mFd;
+    QSocketNotifier *mNotifier;
+    qint64 mDeadline;
+    bool mActive;
+};
+
+#endif
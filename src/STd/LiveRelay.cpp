@@ -0,0 +1,172 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "LiveRelay.h"
+#include "ClientProcess.h"
+
+namespace
+{
+    const qint64 Day = 24 * 3600 * 1000;
+
+    bool IsPosition(const pTimeUpdate &Update)
+    {
+        return Update->GetUpdateReason() == PositionAirplaneReason ||
+               Update->GetUpdateReason() == PositionATCReason;
+    }
+}
+
+LiveRelay::LiveRelay(QString FileName, int Delay, ThreadHelper *Starter)
+    : mReader(FileName), mStarter(Starter), mPollTimer(this), mDelay(Delay), mCatchingUp(true),
+      mFailed(false), mStartTime(-1), mLastTime(0), mDayOffset(0)
+{
+    connect(&mPollTimer, &QTimer::timeout, this, &LiveRelay::Poll);
+}
+
+bool LiveRelay::Start()
+{
+    if (!mReader.Open())
+    {
+        return false;
+    }
+    Poll();
+    if (mFailed)
+    {
+        return false;
+    }
+    qDebug() << "Clients in log:    " << mClients.size();
+    mCatchingUp = false;
+    mPollTimer.start(PollInterval);
+    return true;
+}
+
+bool LiveRelay::HasFailed() const
+{
+    return mFailed;
+}
+
+void LiveRelay::Stop()
+{
+    mPollTimer.stop();
+}
+
+void LiveRelay::Poll()
+{
+    LogEvent Event;
+    while (mReader.ReadNewEvent(Event))
+    {
+        Relay(Event);
+    }
+    if (mReader.HasError())
+    {
+        // no new line and a broken log look the same to ReadNewEvent
+        qDebug() << "Error: Cannot follow the log " << qPrintable(mReader.GetError());
+        mFailed = true;
+        Stop();
+        if (!mCatchingUp)
+        {
+            mStarter->Drain();
+        }
+    }
+}
+
+void LiveRelay::Relay(const LogEvent &Event)
+{
+    qint64 Time = LogTime(Event.Time);
+    pClient client = FSInnReader::ApplyEvent(Event, mClients);
+    if (client == 0)
+    {
+        return;
+    }
+    TimeUpdateContainer *Pending = client->GetTimeUpdateContainer();
+    if (mCatchingUp)
+    {
+        // only the callsign, the rating and the airplane info count
+        Pending->clear();
+        return;
+    }
+    if (mStartTime < 0)
+    {
+        mStartTime = Time;
+        mClock.start();
+    }
+
+    auto Live = mLive.find(client.get());
+    if (Live == mLive.end())
+    {
+        Live = mLive.insert(client.get(), {pClientHandle(), Time, Time});
+    }
+    bool Running = Live->Process != 0 && Live->Process->IsRunning();
+    if (Event.Reason != SBInfoReason && !Pending->isEmpty())
+    {
+        pTimeUpdate Update = Pending->last();
+        if (IsPosition(Update))
+        {
+            // the same values a scenario of this log would send
+            if (Update->GetUpdateReason() == PositionAirplaneReason)
+            {
+                static_cast<AirplanePositionUpdate *>(Update.get())->RoundAsSerialized();
+            }
+            else
+            {
+                static_cast<ControllerPositionUpdate *>(Update.get())->RoundAsSerialized();
+            }
+        }
+        if (Pending->size() == 1 && !Running)
+        {
+            Live->FirstTime = Time;
+        }
+        Update->SetTimeDiff(static_cast<int>(Time - Live->LastTime));
+        Live->LastTime = Time;
+        if (Running && Live->Process->Invoke("AppendUpdate", Q_ARG(pTimeUpdate, Update), Q_ARG(int, TimeToSend(Time))))
+        {
+            Pending->clear();
+            return;
+        }
+        if (Running)
+        {
+            // the process has just finished, a new one takes the update
+            Running = false;
+            Live->FirstTime = Time;
+        }
+    }
+    if (Running || Pending->isEmpty() || !client->IsExportable())
+    {
+        return;
+    }
+
+    // the process gets a client of its own, the one here goes on reading
+    pClient Own;
+    if (client->GetType() == AirplaneType)
+    {
+        Own = pClient(new Airplane(*static_cast<Airplane *>(client.get())));
+    }
+    else
+    {
+        Own = pClient(new Controller(*static_cast<Controller *>(client.get())));
+    }
+    Own->GetTimeUpdateContainer()->first()->SetTimeDiff(TimeToSend(Live->FirstTime));
+    Pending->clear();
+    Live->Process = mStarter->StartClient(ClientView(Own));
+    qDebug() << "Following:         " << qPrintable(client->GetCallsign());
+}
+
+qint64 LiveRelay::LogTime(int Time)
+{
+    // the log only has the time of day
+    qint64 Absolute = Time + mDayOffset;
+    if (Absolute < mLastTime - Day / 2)
+    {
+        mDayOffset += Day;
+        Absolute += Day;
+    }
+    mLastTime = Absolute;
+    return Absolute;
+}
+
+int LiveRelay::TimeToSend(qint64 Time) const
+{
+    qint64 Due = Time - mStartTime + mDelay - mClock.elapsed();
+    return static_cast<int>(qMax(Due, qint64(0)));
+}
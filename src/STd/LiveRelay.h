@@ -0,0 +1,69 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LIVE_RELAY_H_
+#define LIVE_RELAY_H_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include "STLib/FSInnReader.h"
+#include "helper.h"
+
+// Follows an FSInn log that is still written, like tail -f, and replays
+// every new event a fixed delay after the time it was logged. Lines that
+// are in the log already only set up the clients. The clients get a
+// process of their own when they can log on, later events are handed to
+// that process while it runs.
+class LiveRelay : public QObject
+{
+    Q_OBJECT
+public:
+    LiveRelay(QString FileName, int Delay, ThreadHelper *Starter);
+
+    // reads what is in the log already
+    bool Start();
+    // the log could not be read any further
+    bool HasFailed() const;
+
+public slots:
+    // no more lines are read
+    void Stop();
+
+private slots:
+    void Poll();
+
+private:
+    struct LiveClient
+    {
+        // 0 until the client can log on
+        pClientHandle Process;
+        qint64 FirstTime;
+        qint64 LastTime;
+    };
+
+    void Relay(const LogEvent &Event);
+    qint64 LogTime(int Time);
+    int TimeToSend(qint64 Time) const;
+
+    static const int PollInterval = 200;
+
+    FSInnReader mReader;
+    // the clients as far as the log is read, their lists only hold the
+    // updates not handed to a process yet
+    ClientContainer mClients;
+    QHash<const Client *, LiveClient> mLive;
+    ThreadHelper *mStarter;
+    QTimer mPollTimer;
+    QElapsedTimer mClock;
+    int mDelay;
+    bool mCatchingUp;
+    bool mFailed;
+    qint64 mStartTime;
+    qint64 mLastTime;
+    qint64 mDayOffset;
+};
+
+#endif
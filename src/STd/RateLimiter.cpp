@@ -0,0 +1,189 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include "DispatchTimer.h"
+#include "RateLimiter.h"
+
+namespace
+{
+    // a tenth of a second of the rate may go out at once
+    const double BurstTime = 0.1;
+    // a whole packet fits into the byte bucket
+    const double MinByteBurst = 1024;
+
+    const char *ClassName(int Class)
+    {
+        switch (Class)
+        {
+        case PositionLimit:
+            return "positions";
+        case TextLimit:
+            return "text";
+        default:
+            return "other";
+        }
+    }
+}
+
+TokenBucket::TokenBucket(double Rate, double Burst)
+    : mInterval(Rate > 0.0 ? 1e9 / Rate : 0.0), mDepth(static_cast<qint64>(qMax(Burst, 1.0) * mInterval)),
+      mRefilled(0)
+{
+}
+
+qint64 TokenBucket::Reserve(qint64 Now, qint64 NotBefore, int Cost)
+{
+    if (!IsSet())
+    {
+        return NotBefore;
+    }
+    qint64 Arrival = qMax(Now, NotBefore);
+    qint64 Refilled = mRefilled.load(std::memory_order_relaxed);
+    qint64 Next;
+    do
+    {
+        // an idle bucket is full, tokens are not banked beyond that
+        Next = qMax(Refilled, Arrival) + static_cast<qint64>(Cost * mInterval);
+    }
+    while (!mRefilled.compare_exchange_weak(Refilled, Next, std::memory_order_relaxed));
+    // at most mDepth of tokens may be owed when the packet goes out
+    return qMax(Arrival, Next - mDepth);
+}
+
+bool TokenBucket::TryReserve(qint64 Now, int Cost)
+{
+    if (!IsSet())
+    {
+        return true;
+    }
+    qint64 Refilled = mRefilled.load(std::memory_order_relaxed);
+    qint64 Next;
+    do
+    {
+        Next = qMax(Refilled, Now) + static_cast<qint64>(Cost * mInterval);
+        if (Next - mDepth > Now)
+        {
+            return false;
+        }
+    }
+    while (!mRefilled.compare_exchange_weak(Refilled, Next, std::memory_order_relaxed));
+    return true;
+}
+
+void TokenBucket::Refund(int Cost)
+{
+    if (IsSet())
+    {
+        mRefilled.fetch_sub(static_cast<qint64>(Cost * mInterval), std::memory_order_relaxed);
+    }
+}
+
+double TokenBucket::GetBacklog(qint64 Now) const
+{
+    return qMax(mRefilled.load(std::memory_order_relaxed) - mDepth - Now, qint64(0)) / 1e6;
+}
+
+bool TokenBucket::IsSet() const
+{
+    return mInterval > 0.0;
+}
+
+
+RateLimiter::RateLimiter(double Packets, double Bytes)
+    : mPackets(Packets, Packets * BurstTime), mBytes(Bytes, qMax(Bytes * BurstTime, MinByteBurst)), mAdmitted(0),
+      mDeferred(0), mSkipped(0), mDeferredTime(0)
+{
+    for (int i = 0; i < LimitClassCount; i++)
+    {
+        mClasses[i].reset(new TokenBucket(0.0, 0.0));
+    }
+}
+
+void RateLimiter::SetClassRate(LimitClass Class, double Rate)
+{
+    mClasses[Class].reset(new TokenBucket(Rate, Rate * BurstTime));
+}
+
+bool RateLimiter::IsSet() const
+{
+    for (int i = 0; i < LimitClassCount; i++)
+    {
+        if (mClasses[i]->IsSet())
+        {
+            return true;
+        }
+    }
+    return mPackets.IsSet() || mBytes.IsSet();
+}
+
+int RateLimiter::Admit(LimitClass Class, int Bytes)
+{
+    qint64 Now = DispatchTimer::Now();
+    qint64 Start = mClasses[Class]->Reserve(Now, Now, 1);
+    Start = mPackets.Reserve(Now, Start, 1);
+    Start = mBytes.Reserve(Now, Start, Bytes);
+
+    mAdmitted.fetch_add(1, std::memory_order_relaxed);
+    int Wait = static_cast<int>((Start - Now + 999999) / 1000000);
+    if (Wait > 0)
+    {
+        mDeferred.fetch_add(1, std::memory_order_relaxed);
+        mDeferredTime.fetch_add(Wait, std::memory_order_relaxed);
+    }
+    return Wait;
+}
+
+bool RateLimiter::TryAdmit(LimitClass Class, int Bytes)
+{
+    qint64 Now = DispatchTimer::Now();
+    TokenBucket *Bucket = mClasses[Class].get();
+    bool Admitted = false;
+    if (Bucket->TryReserve(Now, 1))
+    {
+        if (mPackets.TryReserve(Now, 1))
+        {
+            if (mBytes.TryReserve(Now, Bytes))
+            {
+                Admitted = true;
+            }
+            else
+            {
+                mPackets.Refund(1);
+            }
+        }
+        if (!Admitted)
+        {
+            Bucket->Refund(1);
+        }
+    }
+    if (Admitted)
+    {
+        mAdmitted.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        mSkipped.fetch_add(1, std::memory_order_relaxed);
+    }
+    return Admitted;
+}
+
+void RateLimiter::Report() const
+{
+    qint64 Now = DispatchTimer::Now();
+    quint64 Deferred = mDeferred.load(std::memory_order_relaxed);
+    qDebug() << "-- Limited:       " << mAdmitted.load(std::memory_order_relaxed) << "packets," << Deferred
+             << "deferred by" << (Deferred > 0 ? mDeferredTime.load() / double(Deferred) : 0.0) << "ms avg,"
+             << mSkipped.load(std::memory_order_relaxed) << "interim skipped";
+    qDebug() << "-- Budget ahead:  " << "packets" << mPackets.GetBacklog(Now) << "ms, bytes" << mBytes.GetBacklog(Now)
+             << "ms";
+    for (int i = 0; i < LimitClassCount; i++)
+    {
+        if (mClasses[i]->IsSet())
+        {
+            qDebug() << "--                " << ClassName(i) << mClasses[i]->GetBacklog(Now) << "ms";
+        }
+    }
+}
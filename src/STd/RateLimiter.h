@@ -0,0 +1,78 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef RATE_LIMITER_H_
+#define RATE_LIMITER_H_
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+// A token bucket kept as the time at which all tokens taken so far are
+// refilled, so taking tokens is a single compare and swap from any
+// thread. Tokens left unused are kept up to the burst size.
+class TokenBucket
+{
+public:
+    // a rate of 0 never limits
+    TokenBucket(double Rate, double Burst);
+
+    // takes Cost tokens, not before NotBefore, returns when they are
+    // there, all times in ns of DispatchTimer::Now
+    qint64 Reserve(qint64 Now, qint64 NotBefore, int Cost);
+    // takes Cost tokens only if they are there now
+    bool TryReserve(qint64 Now, int Cost);
+    // gives back tokens a TryReserve took
+    void Refund(int Cost);
+    // how far ahead the tokens are taken, in ms
+    double GetBacklog(qint64 Now) const;
+    bool IsSet() const;
+
+private:
+    // ns per token
+    double mInterval;
+    // ns of tokens that may be taken at once
+    qint64 mDepth;
+    std::atomic<qint64> mRefilled;
+};
+
+enum LimitClass
+{
+    PositionLimit,
+    TextLimit,
+    OtherLimit,
+    LimitClassCount,
+};
+
+// The packet budget of all clients. A packet takes a token of its class,
+// then a packet and its size in bytes from the global buckets, each not
+// before the one before has it ready. Packets over the budget are sent
+// later, never dropped.
+class RateLimiter
+{
+public:
+    RateLimiter(double Packets, double Bytes);
+
+    void SetClassRate(LimitClass Class, double Rate);
+    bool IsSet() const;
+
+    // ms until the packet may be sent
+    int Admit(LimitClass Class, int Bytes);
+    // for packets that are left out rather than sent late, true if the
+    // budget has room for it now
+    bool TryAdmit(LimitClass Class, int Bytes);
+    void Report() const;
+
+private:
+    std::unique_ptr<TokenBucket> mClasses[LimitClassCount];
+    TokenBucket mPackets;
+    TokenBucket mBytes;
+    std::atomic<quint64> mAdmitted;
+    std::atomic<quint64> mDeferred;
+    std::atomic<quint64> mSkipped;
+    std::atomic<qint64> mDeferredTime;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include "DispatchTimer.h"
+#include "SendTrace.h"
+
+SendTrace &SendTrace::Instance()
+{
+    static SendTrace trace;
+    return trace;
+}
+
+SendTrace::SendTrace()
+    : mOpen(false), mStartTime(0)
+{
+}
+
+bool SendTrace::Open(QString Filename)
+{
+    QMutexLocker Lock(&mMutex);
+    mFile.setFileName(Filename);
+    if (!mFile.open(QFile::WriteOnly | QFile::Truncate | QFile::Text))
+    {
+        qDebug() << "Error: Cannot write file "
+                 << qPrintable(Filename) << ": "
+                 << qPrintable(mFile.errorString());
+        return false;
+    }
+    mStream.setDevice(&mFile);
+    mStartTime = DispatchTimer::Now();
+    mOpen = true;
+    return true;
+}
+
+void SendTrace::Record(const QString &Callsign, const char *Type)
+{
+    // most runs have no trace, they do not take the lock
+    if (!mOpen)
+    {
+        return;
+    }
+    QMutexLocker Lock(&mMutex);
+    if (!mOpen)
+    {
+        return;
+    }
+    mStream << (DispatchTimer::Now() - mStartTime) / 1000000 << ' ' << Callsign << ' ' << Type << '\n';
+}
+
+void SendTrace::Close()
+{
+    QMutexLocker Lock(&mMutex);
+    if (!mOpen)
+    {
+        return;
+    }
+    mOpen = false;
+    mStream.flush();
+    mFile.close();
+}
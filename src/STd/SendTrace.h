@@ -0,0 +1,39 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SEND_TRACE_H_
+#define SEND_TRACE_H_
+
+#include <QFile>
+#include <QMutex>
+#include <QTextStream>
+#include <atomic>
+
+// The packets of all clients in the order they are sent, one line each
+// with the ms since the start, the callsign and the type of the packet.
+// On the virtual clock every run of a scenario writes the same lines, so
+// a regression test can compare them with the ones of an earlier run.
+class SendTrace
+{
+public:
+    static SendTrace &Instance();
+
+    // false if the file cannot be written
+    bool Open(QString Filename);
+    void Record(const QString &Callsign, const char *Type);
+    // writes what is left, later packets are not recorded
+    void Close();
+
+private:
+    SendTrace();
+
+    QMutex mMutex;
+    QFile mFile;
+    QTextStream mStream;
+    std::atomic<bool> mOpen;
+    qint64 mStartTime;
+};
+
+#endif
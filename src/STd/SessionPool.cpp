@@ -0,0 +1,46 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "SessionPool.h"
+
+SessionPool &SessionPool::Instance()
+{
+    static SessionPool pool;
+    return pool;
+}
+
+SessionPool::SessionPool()
+{
+}
+
+VatFsdClient *SessionPool::Acquire()
+{
+    {
+        QMutexLocker Locker(&mLock);
+        if (!mIdle.isEmpty())
+        {
+            return mIdle.takeLast();
+        }
+    }
+    return Vat_CreateNetworkSession(vatServerVatsim, "SimTest 1.0", 1, 0, "MSFS", 0xb9ba,
+                                    "727d1efd5cb9f8d2c28372469d922bb4",
+                                    vatCapsAircraftInfo | vatCapsInterminPos);
+}
+
+void SessionPool::Release(VatFsdClient *Session)
+{
+    QMutexLocker Locker(&mLock);
+    mIdle.append(Session);
+}
+
+void SessionPool::Clear()
+{
+    QMutexLocker Locker(&mLock);
+    for (VatFsdClient *Session : mIdle)
+    {
+        Vat_DestroyNetworkSession(Session);
+    }
+    mIdle.clear();
+}
@@ -0,0 +1,36 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SESSION_POOL_H_
+#define SESSION_POOL_H_
+
+#include <QList>
+#include <QMutex>
+#include "vatlib.h"
+
+// vatlib sessions that are logged off, shared by all client threads. A
+// client takes one to log on and gives it back once its logoff is
+// confirmed, so there are only as many sessions as clients online at
+// the same time.
+class SessionPool
+{
+public:
+    static SessionPool &Instance();
+
+    // an idle session or a new one, 0 if vatlib cannot create one
+    VatFsdClient *Acquire();
+    // the session must be disconnected
+    void Release(VatFsdClient *Session);
+    // destroys the idle sessions
+    void Clear();
+
+private:
+    SessionPool();
+
+    QMutex mLock;
+    QList<VatFsdClient *> mIdle;
+};
+
+#endif
@@ -0,0 +1,197 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include "RateLimiter.h"
+#include "Statistics.h"
+
+namespace
+{
+    // resident set size in kB, -1 where there is no /proc
+    qint64 ResidentSize()
+    {
+        QFile Status("/proc/self/status");
+        if (!Status.open(QFile::ReadOnly))
+        {
+            return -1;
+        }
+        for (const QByteArray &Line : Status.readAll().split('\n'))
+        {
+            if (Line.startsWith("VmRSS:"))
+            {
+                return Line.mid(6).simplified().split(' ').first().toLongLong();
+            }
+        }
+        return -1;
+    }
+
+    int OpenHandles()
+    {
+        QDir Fds("/proc/self/fd");
+        if (!Fds.exists())
+        {
+            return -1;
+        }
+        return Fds.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size();
+    }
+}
+
+const int RunStatistics::LatenessBounds[LatenessBuckets - 1] = {0, 10, 50, 100, 250, 500, 1000, 2000, 5000, 10000, 50000};
+
+RunStatistics &RunStatistics::Instance()
+{
+    static RunStatistics statistics;
+    return statistics;
+}
+
+RunStatistics::RunStatistics()
+    : mPackets(0), mLogons(0), mErrors(0), mDisconnects(0), mReconnects(0), mDropped(0), mFirstFailureTime(-1), mPacketsAtFirstFailure(0),
+      mLastPackets(0), mLastReportTime(0), mPeakRate(0.0), mRateAtFirstFailure(-1.0),
+      mMaxLateness(0), mLoops(0), mLimiter(0)
+{
+    for (int i = 0; i < LatenessBuckets; i++)
+    {
+        mLateness[i] = 0;
+    }
+    mRunTime.start();
+}
+
+void RunStatistics::PacketSent()
+{
+    mPackets.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RunStatistics::LoggedOn()
+{
+    mLogons.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RunStatistics::ErrorReceived()
+{
+    mErrors.fetch_add(1, std::memory_order_relaxed);
+    MarkFirstFailure();
+}
+
+void RunStatistics::Disconnected()
+{
+    mDisconnects.fetch_add(1, std::memory_order_relaxed);
+    MarkFirstFailure();
+}
+
+void RunStatistics::Reconnecting()
+{
+    mReconnects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RunStatistics::PositionDropped()
+{
+    mDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void RunStatistics::SetLimiter(const RateLimiter *Limiter)
+{
+    mLimiter = Limiter;
+}
+
+void RunStatistics::EventDispatched(qint64 Lateness)
+{
+    int Bucket = 0;
+    while (Bucket < LatenessBuckets - 1 && Lateness >= LatenessBounds[Bucket] * 1000LL)
+    {
+        Bucket++;
+    }
+    mLateness[Bucket].fetch_add(1, std::memory_order_relaxed);
+    qint64 Max = mMaxLateness.load(std::memory_order_relaxed);
+    while (Lateness > Max && !mMaxLateness.compare_exchange_weak(Max, Lateness, std::memory_order_relaxed))
+    {
+    }
+}
+
+void RunStatistics::MarkFirstFailure()
+{
+    qint64 unset = -1;
+    if (mFirstFailureTime.compare_exchange_strong(unset, mRunTime.elapsed()))
+    {
+        mPacketsAtFirstFailure = mPackets.load(std::memory_order_relaxed);
+    }
+}
+
+void RunStatistics::Report()
+{
+    qint64 now = mRunTime.elapsed();
+    quint64 packets = mPackets.load(std::memory_order_relaxed);
+    double interval = (now - mLastReportTime) / 1000.0;
+    double rate = interval > 0.0 ? (packets - mLastPackets) / interval : 0.0;
+    double average = now > 0 ? packets / (now / 1000.0) : 0.0;
+    mPeakRate = qMax(mPeakRate, rate);
+
+    qint64 firstFailure = mFirstFailureTime.load();
+    if (firstFailure >= 0 && mRateAtFirstFailure < 0.0)
+    {
+        // the interval in which the first failure happened
+        mRateAtFirstFailure = rate;
+    }
+
+    qDebug() << "---------------------------------------------------------";
+    qDebug() << "-- Run time:      " << now / 1000.0 << "s";
+    qDebug() << "-- Packets sent:  " << packets;
+    qDebug() << "-- Rate:          " << rate << "packets/s (avg" << average << ", peak" << mPeakRate << ")";
+    qDebug() << "-- Logons:        " << mLogons.load();
+    qDebug() << "-- Server errors: " << mErrors.load();
+    qDebug() << "-- Disconnects:   " << mDisconnects.load();
+    qDebug() << "-- Reconnects:    " << mReconnects.load();
+    qDebug() << "-- Late dropped:  " << mDropped.load();
+    if (firstFailure >= 0)
+    {
+        qDebug() << "-- First failure: " << firstFailure / 1000.0 << "s after"
+                 << mPacketsAtFirstFailure.load() << "packets at" << mRateAtFirstFailure << "packets/s";
+    }
+    if (mLimiter != 0)
+    {
+        mLimiter->Report();
+    }
+    ReportLateness();
+    qDebug() << "---------------------------------------------------------";
+
+    mLastPackets = packets;
+    mLastReportTime = now;
+}
+
+void RunStatistics::ReportLateness()
+{
+    quint64 Counts[LatenessBuckets];
+    quint64 Total = 0;
+    for (int i = 0; i < LatenessBuckets; i++)
+    {
+        Counts[i] = mLateness[i].load(std::memory_order_relaxed);
+        Total += Counts[i];
+    }
+    if (Total == 0)
+    {
+        return;
+    }
+    qDebug() << "-- Timer lateness:" << "max" << mMaxLateness.load() / 1000.0 << "us";
+    for (int i = 0; i < LatenessBuckets; i++)
+    {
+        if (Counts[i] == 0)
+        {
+            continue;
+        }
+        QString Range = i == 0 ? QString("early") :
+                        i == LatenessBuckets - 1 ? QString(">= %1 us").arg(LatenessBounds[i - 1]) :
+                        QString("< %1 us").arg(LatenessBounds[i]);
+        qDebug() << "--                " << qPrintable(Range.leftJustified(10)) << Counts[i]
+                 << "(" << 100.0 * Counts[i] / Total << "% )";
+    }
+}
+
+void RunStatistics::ReportLoop()
+{
+    mLoops++;
+    qDebug() << "-- Loop" << mLoops << "done: RSS" << ResidentSize() << "kB, handles" << OpenHandles()
+             << ", packets" << mPackets.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef STATISTICS_H_
+#define STATISTICS_H_
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <atomic>
+
+class RateLimiter;
+
+// Counters shared by all client threads. The counters are updated
+// lock-free from the client threads, Report() runs in the main thread.
+class RunStatistics : public QObject
+{
+    Q_OBJECT
+public:
+    static RunStatistics &Instance();
+
+    void PacketSent();
+    void LoggedOn();
+    void ErrorReceived();
+    void Disconnected();
+    void Reconnecting();
+    // a late position left out by the catch up policy
+    void PositionDropped();
+    // its state is part of the report
+    void SetLimiter(const RateLimiter *Limiter);
+    // ns an event timer fired after its deadline, negative if early
+    void EventDispatched(qint64 Lateness);
+
+public slots:
+    void Report();
+    // the footprint of STd itself after every loop of a soak test
+    void ReportLoop();
+
+private:
+    RunStatistics();
+    void MarkFirstFailure();
+    void ReportLateness();
+
+    // upper bounds of the lateness buckets in us, the last one is open
+    static const int LatenessBuckets = 12;
+    static const int LatenessBounds[LatenessBuckets - 1];
+
+    QElapsedTimer mRunTime;
+    std::atomic<quint64> mPackets;
+    std::atomic<quint64> mLogons;
+    std::atomic<quint64> mErrors;
+    std::atomic<quint64> mDisconnects;
+    std::atomic<quint64> mReconnects;
+    std::atomic<quint64> mDropped;
+    std::atomic<qint64> mFirstFailureTime;
+    std::atomic<quint64> mPacketsAtFirstFailure;
+    std::atomic<quint64> mLateness[LatenessBuckets];
+    std::atomic<qint64> mMaxLateness;
+
+    quint64 mLastPackets;
+    qint64 mLastReportTime;
+    double mPeakRate;
+    double mRateAtFirstFailure;
+    int mLoops;
+    const RateLimiter *mLimiter;
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "VirtualClock.h"
+#include "DispatchTimer.h"
+
+VirtualClock &VirtualClock::Instance()
+{
+    static VirtualClock clock;
+    return clock;
+}
+
+VirtualClock::VirtualClock()
+    : mNow(0), mSequence(0), mAdvancePosted(false)
+{
+}
+
+qint64 VirtualClock::Now() const
+{
+    return mNow;
+}
+
+void VirtualClock::Schedule(DispatchTimer *Timer, qint64 Deadline)
+{
+    Cancel(Timer);
+    Key At(Deadline, mSequence++);
+    mQueue.insert(At, Timer);
+    mScheduled.insert(Timer, At);
+    PostAdvance();
+}
+
+void VirtualClock::Cancel(DispatchTimer *Timer)
+{
+    auto iter = mScheduled.find(Timer);
+    if (iter != mScheduled.end())
+    {
+        mQueue.remove(*iter);
+        mScheduled.erase(iter);
+    }
+}
+
+void VirtualClock::Advance()
+{
+    mAdvancePosted = false;
+    if (mQueue.isEmpty())
+    {
+        return;
+    }
+    auto First = mQueue.begin();
+    DispatchTimer *Timer = First.value();
+    // a deadline that has passed fires now, time never goes back
+    mNow = qMax(mNow, First.key().first);
+    mScheduled.remove(Timer);
+    mQueue.erase(First);
+    Timer->Expired();
+    PostAdvance();
+}
+
+void VirtualClock::PostAdvance()
+{
+    if (!mAdvancePosted && !mQueue.isEmpty())
+    {
+        mAdvancePosted = true;
+        QMetaObject::invokeMethod(this, "Advance", Qt::QueuedConnection);
+    }
+}
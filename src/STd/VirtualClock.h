@@ -0,0 +1,50 @@
+/*  Copyright (C) 2013 VATSIM Community
+ *  This Source Code Form is subject to the terms of the Mozilla Public
+ *  License, v. 2.0. If a copy of the MPL was not distributed with this
+ *  file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef VIRTUAL_CLOCK_H_
+#define VIRTUAL_CLOCK_H_
+
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+
+class DispatchTimer;
+
+// Simulated time for test runs. It stands still while the events that
+// are due are handled, then jumps to the earliest deadline of the timers
+// that are set. A scenario runs as fast as its events can be handled.
+// Timers fire in the order of their deadlines, and timers with the same
+// deadline in the order they were set, so every run is the same. The
+// clock and all clients live in the main thread.
+class VirtualClock : public QObject
+{
+    Q_OBJECT
+public:
+    static VirtualClock &Instance();
+
+    // ns since the start of the run
+    qint64 Now() const;
+    void Schedule(DispatchTimer *Timer, qint64 Deadline);
+    void Cancel(DispatchTimer *Timer);
+
+private slots:
+    void Advance();
+
+private:
+    VirtualClock();
+    // the next step comes after the events posted so far
+    void PostAdvance();
+
+    typedef QPair<qint64, quint64> Key;
+
+    qint64 mNow;
+    quint64 mSequence;
+    QMap<Key, DispatchTimer *> mQueue;
+    QHash<DispatchTimer *, Key> mScheduled;
+    bool mAdvancePosted;
+};
+
+#endif
@@ -5,24 +5,250 @@
 
 #include <QThread>
 #include <QCoreApplication>
+#include <QElapsedTimer>
+#include <chrono>
+#include <csignal>
 #include "helper.h"
+#include "AirplaneClientProcess.h"
+#include "ControllerClientProcess.h"
+#include "DispatchTimer.h"
 
-ThreadHelper::ThreadHelper(QList<QThread *> *Threads)
+namespace
+{
+    volatile std::sig_atomic_t StopRequested = 0;
+
+    void StopHandler(int Signal)
+    {
+        StopRequested = 1;
+        std::signal(Signal, SIG_DFL);
+    }
+}
+
+ClientHandle::ClientHandle(ClientProcess *Process)
+    : mProcess(Process)
+{
+}
+
+bool ClientHandle::Invoke(const char *Method, QGenericArgument Arg0, QGenericArgument Arg1)
+{
+    QMutexLocker Locker(&mLock);
+    if (mProcess == 0)
+    {
+        return false;
+    }
+    // a posted event still waiting when the process is deleted is dropped
+    QMetaObject::invokeMethod(mProcess, Method, Qt::QueuedConnection, Arg0, Arg1);
+    return true;
+}
+
+bool ClientHandle::IsRunning() const
+{
+    QMutexLocker Locker(&mLock);
+    return mProcess != 0;
+}
+
+void ClientHandle::Clear()
+{
+    QMutexLocker Locker(&mLock);
+    mProcess = 0;
+}
+
+
+ThreadHelper::ThreadHelper(int DrainTimeout)
+    : mDraining(false), mDrainTimeout(DrainTimeout)
 {
-    mThreads = Threads;
 }
 
-void ThreadHelper::AllThreadsClosed()
+pClientHandle ThreadHelper::StartClient(ClientView View, const Checkpoint *Resume)
 {
-    //cout << "all threads closed?" << endl;
-    for (auto iter = mThreads->begin(); iter != mThreads->end(); ++iter)
+    ClientProgress Progress;
+    if (Resume != 0 && !Resume->GetClient(View.GetCallsign(), Progress))
+    {
+        return 0;
+    }
+
+    ClientProcess *process = 0;
+    if (View.GetType() == AirplaneType)
     {
-        (*iter)->wait(10); // give the thread time to finish... in Qt finished means not he is finished completely ;)
-        if ((*iter)->isRunning())
+        process = new AirplaneClientProcess(View);
+    }
+    else if (View.GetType() == ControllerType)
+    {
+        process = new ControllerClientProcess(View);
+    }
+    if (process == 0)
+    {
+        return 0;
+    }
+    if (Resume != 0 && !process->Resume(Progress, Resume->GetTime()))
+    {
+        delete process;
+        return 0;
+    }
+    pClientHandle Handle(new ClientHandle(process));
+    ClientHandle *Key = Handle.get();
+    mRunning.insert(Key, {Handle, process->GetProgressRecord(), QPointer<QThread>()});
+    // directly in the thread of the process, before it can be deleted
+    QObject::connect(process, &ClientProcess::ClientFinished, [Handle]()
+    {
+        Handle->Clear();
+    });
+    if (DispatchTimer::Virtual)
+    {
+        // simulated time is only the same for clients of one thread
+        QObject::connect(process, &ClientProcess::ClientFinished, process, &QObject::deleteLater);
+        QObject::connect(process, &ClientProcess::ClientFinished, this, [this, Key]()
         {
-            return;
+            ClientClosed(Key);
+        }, Qt::QueuedConnection);
+        QMetaObject::invokeMethod(process, "Run", Qt::QueuedConnection);
+        return Handle;
+    }
+    QThread *thread = new QThread();
+    QThread::connect(thread, &QThread::started, process, &ClientProcess::Run);
+    QThread::connect(process, &ClientProcess::ClientFinished, thread, &QThread::quit);
+    // the process is deleted in its thread as it ends, the thread object
+    // waits for the thread to return before it goes
+    QThread::connect(thread, &QThread::finished, process, &QObject::deleteLater);
+    QThread::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    QThread::connect(thread, &QThread::finished, this, [this, Key]()
+    {
+        ClientClosed(Key);
+    });
+
+    process->moveToThread(thread);
+    mRunning[Key].Thread = thread;
+    thread->start();
+    return Handle;
+}
+
+int ThreadHelper::GetRunning() const
+{
+    return mRunning.size();
+}
+
+bool ThreadHelper::IsDraining() const
+{
+    return mDraining;
+}
+
+void ThreadHelper::CollectProgress(Checkpoint &Point) const
+{
+    for (const RunningClient &Running : mRunning)
+    {
+        Point.AddClient(Running.Progress->GetCallsign(), Running.Progress->Get());
+    }
+}
+
+bool ThreadHelper::StopThreads(int Timeout)
+{
+    QElapsedTimer Clock;
+    Clock.start();
+    for (const RunningClient &Running : mRunning)
+    {
+        if (Running.Thread != 0)
+        {
+            Running.Thread->quit();
+        }
+    }
+    for (const RunningClient &Running : mRunning)
+    {
+        if (Running.Thread != 0 && !Running.Thread->wait(static_cast<unsigned long>(qMax(Timeout - Clock.elapsed(), qint64(0)))))
+        {
+            return false;
         }
     }
+    return true;
+}
+
+void ThreadHelper::Drain()
+{
+    if (mDraining)
+    {
+        return;
+    }
+    mDraining = true;
+    // the clients that wait for their logoff send nothing meanwhile
+    ClientProcess::Draining = true;
+    qDebug() << "Stopping, logging off" << mRunning.size() << "clients";
+    if (mRunning.isEmpty())
+    {
+        QCoreApplication::exit();
+        return;
+    }
+    mToStop = mRunning.keys();
+    StopMore();
+    QTimer::singleShot(mDrainTimeout, this, SLOT(DrainTimedOut()));
+}
+
+void ThreadHelper::DrainTimedOut()
+{
+    qDebug() << "Drain timeout," << mRunning.size() << "clients did not log off";
     QCoreApplication::exit();
 }
 
+void ThreadHelper::ClientClosed(ClientHandle *Handle)
+{
+    // the handle goes with the entry, nothing refers to it any more
+    if (mStopping.remove(Handle))
+    {
+        StopMore();
+    }
+    mRunning.remove(Handle);
+    // a followed log may bring new clients until it is stopped
+    if (mRunning.isEmpty() && (!ClientProcess::Live || mDraining))
+    {
+        QCoreApplication::exit();
+    }
+}
+
+void ThreadHelper::StopMore()
+{
+    while (mStopping.size() < MaxStopping && !mToStop.isEmpty())
+    {
+        ClientHandle *Handle = mToStop.takeLast();
+        // a process that finished by itself is closed without a stop
+        if (mRunning.contains(Handle) && mRunning[Handle].Handle->Invoke("Stop"))
+        {
+            mStopping.insert(Handle);
+        }
+    }
+}
+
+SignalWatcher::SignalWatcher()
+    : mTimer(this)
+{
+    std::signal(SIGINT, StopHandler);
+    std::signal(SIGTERM, StopHandler);
+    connect(&mTimer, &QTimer::timeout, this, &SignalWatcher::Check);
+    mTimer.start(100);
+}
+
+void SignalWatcher::Check()
+{
+    if (StopRequested)
+    {
+        StopRequested = 0;
+        emit Stop();
+    }
+}
+
+PacketPacer::PacketPacer(int PacketsPerSecond)
+    : mInterval(1000000000LL / qMax(PacketsPerSecond, 1)), mNextSlot(0)
+{
+}
+
+int PacketPacer::Reserve()
+{
+    qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch()).count();
+    qint64 slot = mNextSlot.load();
+    qint64 start;
+    do
+    {
+        // never bank unused slots, otherwise an idle phase ends in a burst
+        start = qMax(slot, now);
+    }
+    while (!mNextSlot.compare_exchange_weak(slot, start + mInterval));
+    return static_cast<int>((start - now) / 1000000);
+}
@@ -6,19 +6,125 @@
 #ifndef HELPER_H_
 #define HELPER_H_
 
+#include <QMutex>
 #include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTimer>
+#include <atomic>
+#include <memory>
+#include "STLib/ClientView.h"
+#include "Checkpoint.h"
 
+class ClientProcess;
+class QThread;
+
+// A reference to a client process that any thread may use. It is cleared
+// under its lock as the process finishes, before the process can be
+// deleted, so a call posted under the lock always finds the process.
+class ClientHandle
+{
+public:
+    explicit ClientHandle(ClientProcess *Process);
+
+    // posts the call to the process, false once it has finished
+    bool Invoke(const char *Method, QGenericArgument Arg0 = QGenericArgument(),
+                QGenericArgument Arg1 = QGenericArgument());
+    bool IsRunning() const;
+    void Clear();
+
+private:
+    mutable QMutex mLock;
+    ClientProcess *mProcess;
+};
+
+typedef std::shared_ptr<ClientHandle> pClientHandle;
+
+// Starts the client threads and quits the application when the last one
+// has finished. A finished client is deleted together with its thread.
+// On the virtual clock the clients run in the main thread instead.
 class ThreadHelper : public QObject
 {
     Q_OBJECT
 public:
-    ThreadHelper(QList<QThread *> *Threads);
+    ThreadHelper(int DrainTimeout);
+
+    // replays the view in a thread of its own, 0 for clients of no type
+    // and for clients the checkpoint to resume from has as done
+    pClientHandle StartClient(ClientView View, const Checkpoint *Resume = 0);
+    int GetRunning() const;
+    bool IsDraining() const;
+    // adds the clients that are still running
+    void CollectProgress(Checkpoint &Point) const;
+    // after the event loop, ends the threads still running and waits at
+    // most Timeout ms for them, false if some are still running
+    bool StopThreads(int Timeout);
 
 public slots:
-    void AllThreadsClosed();
+    // logs off all clients, a few at a time, and quits when they are done
+    // or the drain timeout has passed
+    void Drain();
+
+private slots:
+    void DrainTimedOut();
+
+private:
+    struct RunningClient
+    {
+        pClientHandle Handle;
+        pProgressRecord Progress;
+        // 0 on the virtual clock, the thread object is deleted in the
+        // main thread
+        QPointer<QThread> Thread;
+    };
+
+    void ClientClosed(ClientHandle *Handle);
+    void StopMore();
+
+    // clients logging off at the same time during a drain
+    static const int MaxStopping = 32;
+
+    // only changed in the main thread, finished arrives queued; the
+    // handles are the keys, as the address of a deleted process may be
+    // taken by a new one before its end arrives here
+    QHash<ClientHandle *, RunningClient> mRunning;
+    QList<ClientHandle *> mToStop;
+    QSet<ClientHandle *> mStopping;
+    bool mDraining;
+    int mDrainTimeout;
+};
+
+// Turns SIGINT and SIGTERM into the Stop signal. The handler only sets a
+// flag, a timer of the main thread looks at it. A second signal ends the
+// program right away.
+class SignalWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    SignalWatcher();
+
+signals:
+    void Stop();
+
+private slots:
+    void Check();
+
+private:
+    QTimer mTimer;
+};
+
+// Hands out send slots at a fixed aggregate rate to all client threads.
+class PacketPacer
+{
+public:
+    PacketPacer(int PacketsPerSecond);
+
+    // reserves the next free slot, returns the delay until it in ms
+    int Reserve();
 
 private:
-    QList<QThread *> *mThreads;
+    qint64 mInterval;
+    std::atomic<qint64> mNextSlot;
 };
 
 #endif
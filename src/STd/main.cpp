@@ -6,12 +6,23 @@
 //#define VATSIM_GERMANY_TEST
 
 #include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <cstdlib>
 
 #include "STLib/ClientContainer.h"
+#include "STLib/FSInnReader.h"
+#include "STLib/ClientView.h"
 #include "ClientProcess.h"
-#include "AirplaneClientProcess.h"
-#include "ControllerClientProcess.h"
 #include "helper.h"
+#include "Checkpoint.h"
+#include "DispatchTimer.h"
+#include "LiveRelay.h"
+#include "RateLimiter.h"
+#include "SendTrace.h"
+#include "SessionPool.h"
+#include "Statistics.h"
+#include "VirtualClock.h"
 
 #ifdef VATSIM_GERMANY_TEST
 #define SERVER_ADDR "vatsim-germany.org"
@@ -25,12 +36,69 @@
 #define USER_PASS   "sup"
 #endif
 #define DEFAULT_FILENAME "../Logs/Onlineday_LOWW.xml"
+#define REPORT_INTERVAL  10
+#define FOLLOW_DELAY     5000
+#define DRAIN_TIMEOUT    10000
+#define THREAD_STOP_TIMEOUT 2000
+#define MIN_LOOP_PERIOD  1000
+#define CHECKPOINT_INTERVAL 60
+#define RECONNECT_BASE   1000
+#define RECONNECT_MAX    60000
+#define RECONNECT_RATE   20
+#define BURST_LIMIT      5
+#define PHASE_PERIOD     5000
 
 
 QString ClientProcess::Server = SERVER_ADDR;
 qint16 ClientProcess::Port = SERVER_PORT;
 QString ClientProcess::Username = USER_ID;
 QString ClientProcess::Password = USER_PASS;
+bool ClientProcess::Blast = false;
+PacketPacer *ClientProcess::Pacer = 0;
+int ClientProcess::InterimRate = 0;
+QString ClientProcess::InterimReceiver = "";
+bool ClientProcess::Live = false;
+int ClientProcess::LoopPeriod = 0;
+int ClientProcess::LoopRotation = 0;
+int ClientProcess::ReconnectBase = RECONNECT_BASE;
+int ClientProcess::ReconnectMax = RECONNECT_MAX;
+PacketPacer *ClientProcess::ReconnectPacer = 0;
+CatchUpPolicy ClientProcess::CatchUp = SendAllPolicy;
+int ClientProcess::BurstLimit = BURST_LIMIT;
+RateLimiter *ClientProcess::Limiter = 0;
+PhaseMode ClientProcess::Phase = NaturalPhase;
+int ClientProcess::PhasePeriod = PHASE_PERIOD;
+bool ClientProcess::NullTransport = false;
+std::atomic<bool> ClientProcess::Draining(false);
+bool DispatchTimer::Precise = false;
+int DispatchTimer::SpinWindow = 0;
+bool DispatchTimer::Virtual = false;
+
+// Clients the drain gave up on may still be inside vatlib and use the
+// statistics, which must not be torn down under them.
+void EndRemainingClients(ThreadHelper *Helper, int Result)
+{
+    bool Stopped = Helper->StopThreads(THREAD_STOP_TIMEOUT);
+    // the packets sent after this are not part of the trace
+    SendTrace::Instance().Close();
+    if (!Stopped)
+    {
+        RunStatistics::Instance().Report();
+        qDebug() << "Client threads did not end, exiting without cleanup";
+        std::_Exit(Result);
+    }
+}
+
+// scenarios end in .xml, maybe followed by .gz, everything else is read
+// as an FSInn log
+bool IsScenarioFile(QString FileName)
+{
+    if (GzipFile::IsCompressedName(FileName))
+    {
+        FileName.chop(3);
+    }
+    return FileName.endsWith(".xml", Qt::CaseInsensitive);
+}
 
 int main(int argc, char *argv[])
 {
@@ -41,7 +109,7 @@ int main(int argc, char *argv[])
     parser.setApplicationDescription("traffic simulator is a tool to replay recorded traffic to an FSD server.");
     parser.addHelpOption();
     parser.addOption({{"x", "xml"},
-                      QCoreApplication::translate("main", "Scenario <scenariofile> in xml format"),
+                      QCoreApplication::translate("main", "Scenario <scenariofile> in xml format or an FSInn log, may be gzip compressed"),
                       QCoreApplication::translate("main", "scenariofile"),
                       DEFAULT_FILENAME
                      });
@@ -65,6 +133,163 @@ int main(int argc, char *argv[])
                       QCoreApplication::translate("main", "password"),
                       USER_PASS
                      });
+    parser.addOption({{"b", "blast"},
+                      QCoreApplication::translate("main", "Ignore the recorded timing and send all events as fast as possible")
+                     });
+    parser.addOption({{"r", "rate"},
+                      QCoreApplication::translate("main", "Blast mode with an aggregate rate of <packets> per second"),
+                      QCoreApplication::translate("main", "packets")
+                     });
+    parser.addOption({{"i", "interval"},
+                      QCoreApplication::translate("main", "Report statistics every <seconds>"),
+                      QCoreApplication::translate("main", "seconds"),
+                      QString::number(REPORT_INTERVAL)
+                     });
+    parser.addOption({{"k", "copies"},
+                      QCoreApplication::translate("main", "Replay every client <count> times"),
+                      QCoreApplication::translate("main", "count"),
+                      "1"
+                     });
+    parser.addOption({"lat-offset",
+                      QCoreApplication::translate("main", "Move every copy <degrees> further north than the previous one"),
+                      QCoreApplication::translate("main", "degrees"),
+                      "0"
+                     });
+    parser.addOption({"long-offset",
+                      QCoreApplication::translate("main", "Move every copy <degrees> further east than the previous one"),
+                      QCoreApplication::translate("main", "degrees"),
+                      "0"
+                     });
+    parser.addOption({"interim",
+                      QCoreApplication::translate("main", "Interpolate <hz> positions per second between the recorded ones"),
+                      QCoreApplication::translate("main", "hz"),
+                      "0"
+                     });
+    parser.addOption({"interim-receiver",
+                      QCoreApplication::translate("main", "Send the interpolated positions as interim updates to <callsign>"),
+                      QCoreApplication::translate("main", "callsign")
+                     });
+    parser.addOption({"time-shift",
+                      QCoreApplication::translate("main", "Start every copy <ms> later than the previous one"),
+                      QCoreApplication::translate("main", "ms"),
+                      "0"
+                     });
+    parser.addOption({"box",
+                      QCoreApplication::translate("main", "Replay only clients that enter the box <lat1,long1,lat2,long2>, west before east"),
+                      QCoreApplication::translate("main", "lat1,long1,lat2,long2")
+                     });
+    parser.addOption({"radius",
+                      QCoreApplication::translate("main", "Replay only clients that come within <nm> of <lat,long>"),
+                      QCoreApplication::translate("main", "lat,long,nm")
+                     });
+    parser.addOption({{"f", "follow"},
+                      QCoreApplication::translate("main", "Follow an FSInn log that is still written and relay its new lines")
+                     });
+    parser.addOption({"follow-delay",
+                      QCoreApplication::translate("main", "Relay every followed line <ms> after its logged time"),
+                      QCoreApplication::translate("main", "ms"),
+                      QString::number(FOLLOW_DELAY)
+                     });
+    parser.addOption({"drain-timeout",
+                      QCoreApplication::translate("main", "On SIGINT or SIGTERM, wait at most <ms> for the clients to log off"),
+                      QCoreApplication::translate("main", "ms"),
+                      QString::number(DRAIN_TIMEOUT)
+                     });
+    parser.addOption({"loop",
+                      QCoreApplication::translate("main", "Start the scenario over at its end until stopped, for soak tests")
+                     });
+    parser.addOption({"loop-rotate",
+                      QCoreApplication::translate("main", "Give every client one of <count> callsigns per loop, in turn"),
+                      QCoreApplication::translate("main", "count"),
+                      "0"
+                     });
+    parser.addOption({"checkpoint",
+                      QCoreApplication::translate("main", "Write the progress of the replay to <file> now and then"),
+                      QCoreApplication::translate("main", "file")
+                     });
+    parser.addOption({"checkpoint-interval",
+                      QCoreApplication::translate("main", "Write the checkpoint every <seconds>"),
+                      QCoreApplication::translate("main", "seconds"),
+                      QString::number(CHECKPOINT_INTERVAL)
+                     });
+    parser.addOption({"resume",
+                      QCoreApplication::translate("main", "Continue the replay from the checkpoint file")
+                     });
+    parser.addOption({"reconnect-base",
+                      QCoreApplication::translate("main", "Log a dropped client on again after <ms>, doubled on every failure, 0 to wait for its next event"),
+                      QCoreApplication::translate("main", "ms"),
+                      QString::number(RECONNECT_BASE)
+                     });
+    parser.addOption({"reconnect-max",
+                      QCoreApplication::translate("main", "Wait at most <ms> before a reconnect"),
+                      QCoreApplication::translate("main", "ms"),
+                      QString::number(RECONNECT_MAX)
+                     });
+    parser.addOption({"reconnect-rate",
+                      QCoreApplication::translate("main", "Reconnect at most <count> clients per second, 0 for no limit"),
+                      QCoreApplication::translate("main", "count"),
+                      QString::number(RECONNECT_RATE)
+                     });
+    parser.addOption({"catch-up",
+                      QCoreApplication::translate("main", "What a late client does with positions that are out of date: all, latest or burst"),
+                      QCoreApplication::translate("main", "policy"),
+                      "all"
+                     });
+    parser.addOption({"burst",
+                      QCoreApplication::translate("main", "Positions out of date a late client still sends in a row with --catch-up burst"),
+                      QCoreApplication::translate("main", "count"),
+                      QString::number(BURST_LIMIT)
+                     });
+    parser.addOption({"phase",
+                      QCoreApplication::translate("main", "When clients send their positions: natural as logged, aligned in bursts on a common beat, or spread evenly over the beat"),
+                      QCoreApplication::translate("main", "mode"),
+                      "natural"
+                     });
+    parser.addOption({"phase-period",
+                      QCoreApplication::translate("main", "The beat of --phase aligned and spread, in <ms>"),
+                      QCoreApplication::translate("main", "ms"),
+                      QString::number(PHASE_PERIOD)
+                     });
+    parser.addOption({"timer",
+                      QCoreApplication::translate("main", "Timer of the events: coarse, or precise for latency studies, with a timerfd on Linux"),
+                      QCoreApplication::translate("main", "backend"),
+                      "coarse"
+                     });
+    parser.addOption({"spin",
+                      QCoreApplication::translate("main", "With --timer precise, busy poll the last <us> before every event"),
+                      QCoreApplication::translate("main", "us"),
+                      "0"
+                     });
+    parser.addOption({"null-transport",
+                      QCoreApplication::translate("main", "Connect to no server, every logon succeeds and packets go nowhere")
+                     });
+    parser.addOption({"virtual",
+                      QCoreApplication::translate("main", "Run on simulated time that jumps to the next event, with the null transport")
+                     });
+    parser.addOption({"trace-sends",
+                      QCoreApplication::translate("main", "Write the time, callsign and type of every packet sent to <file>, to compare runs on the virtual clock"),
+                      QCoreApplication::translate("main", "file")
+                     });
+    parser.addOption({"limit-packets",
+                      QCoreApplication::translate("main", "Send at most <count> packets per second of all clients, later ones wait"),
+                      QCoreApplication::translate("main", "count"),
+                      "0"
+                     });
+    parser.addOption({"limit-bytes",
+                      QCoreApplication::translate("main", "Send at most <bytes> per second of all clients, later packets wait"),
+                      QCoreApplication::translate("main", "bytes"),
+                      "0"
+                     });
+    parser.addOption({"limit-positions",
+                      QCoreApplication::translate("main", "Send at most <count> position updates per second, within the packet limit"),
+                      QCoreApplication::translate("main", "count"),
+                      "0"
+                     });
+    parser.addOption({"limit-text",
+                      QCoreApplication::translate("main", "Send at most <count> text messages per second, within the packet limit"),
+                      QCoreApplication::translate("main", "count"),
+                      "0"
+                     });
 
     // Process the actual command line arguments given by the user
     parser.process(a);
@@ -74,48 +299,312 @@ int main(int argc, char *argv[])
     ClientProcess::Port = parser.value("port").toInt();
     ClientProcess::Username = parser.value("user");
     ClientProcess::Password = parser.value("password");
+    ClientProcess::Blast = parser.isSet("blast") || parser.isSet("rate");
+    if (parser.isSet("rate"))
+    {
+        ClientProcess::Pacer = new PacketPacer(parser.value("rate").toInt());
+    }
+    ClientProcess::InterimRate = parser.value("interim").toInt();
+    ClientProcess::InterimReceiver = parser.value("interim-receiver");
+    ClientProcess::Live = parser.isSet("follow");
+    ClientProcess::ReconnectBase = qMax(parser.value("reconnect-base").toInt(), 0);
+    ClientProcess::ReconnectMax = qMax(parser.value("reconnect-max").toInt(), ClientProcess::ReconnectBase);
+    if (parser.value("reconnect-rate").toInt() > 0)
+    {
+        ClientProcess::ReconnectPacer = new PacketPacer(parser.value("reconnect-rate").toInt());
+    }
+    QString CatchUp = parser.value("catch-up");
+    if (CatchUp == "latest")
+    {
+        ClientProcess::CatchUp = LatestPolicy;
+    }
+    else if (CatchUp == "burst")
+    {
+        ClientProcess::CatchUp = BurstPolicy;
+        ClientProcess::BurstLimit = qMax(parser.value("burst").toInt(), 0);
+    }
+    else if (CatchUp != "all")
+    {
+        qDebug() << "Error: unknown catch up policy " << qPrintable(CatchUp);
+        return 1;
+    }
+    QString Phase = parser.value("phase");
+    if (Phase == "aligned")
+    {
+        ClientProcess::Phase = AlignedPhase;
+    }
+    else if (Phase == "spread")
+    {
+        ClientProcess::Phase = SpreadPhase;
+    }
+    else if (Phase != "natural")
+    {
+        qDebug() << "Error: unknown phase mode " << qPrintable(Phase);
+        return 1;
+    }
+    ClientProcess::PhasePeriod = qMax(parser.value("phase-period").toInt(), 1);
+    QString Timer = parser.value("timer");
+    if (Timer != "coarse" && Timer != "precise")
+    {
+        qDebug() << "Error: unknown timer " << qPrintable(Timer);
+        return 1;
+    }
+    DispatchTimer::Precise = Timer == "precise";
+    DispatchTimer::Virtual = parser.isSet("virtual");
+    // no server keeps up with simulated time
+    ClientProcess::NullTransport = parser.isSet("null-transport") || DispatchTimer::Virtual;
+    DispatchTimer::SpinWindow = DispatchTimer::Precise ? qMax(parser.value("spin").toInt(), 0) : 0;
+    RateLimiter *Limiter = new RateLimiter(parser.value("limit-packets").toDouble(), parser.value("limit-bytes").toDouble());
+    Limiter->SetClassRate(PositionLimit, parser.value("limit-positions").toDouble());
+    Limiter->SetClassRate(TextLimit, parser.value("limit-text").toDouble());
+    if (Limiter->IsSet())
+    {
+        ClientProcess::Limiter = Limiter;
+        RunStatistics::Instance().SetLimiter(Limiter);
+    }
+    else
+    {
+        delete Limiter;
+    }
+    if (ClientProcess::Live && (IsScenarioFile(FileName) || ClientProcess::Blast))
+    {
+        qDebug() << "Error: only an FSInn log can be followed, and not in blast mode";
+        return 1;
+    }
+    if (ClientProcess::Live && (parser.isSet("copies") || parser.isSet("time-shift") || parser.isSet("lat-offset") ||
+                                parser.isSet("long-offset") || parser.isSet("box") || parser.isSet("radius")))
+    {
+        qDebug() << "Error: a followed log is replayed as it is, without copies, shifts or filters";
+        return 1;
+    }
+    if (parser.isSet("loop") && (ClientProcess::Live || ClientProcess::Blast))
+    {
+        qDebug() << "Error: loops need the recorded timing of a whole scenario";
+        return 1;
+    }
+    QString CheckpointFile = parser.value("checkpoint");
+    if (parser.isSet("resume") && CheckpointFile.isEmpty())
+    {
+        qDebug() << "Error: --resume needs the --checkpoint file";
+        return 1;
+    }
+    if (!CheckpointFile.isEmpty() && (ClientProcess::Live || ClientProcess::Blast || parser.isSet("loop")))
+    {
+        qDebug() << "Error: checkpoints need the recorded timing of a single run";
+        return 1;
+    }
+    if (DispatchTimer::Virtual && (ClientProcess::Live || ClientProcess::Blast || parser.isSet("loop") ||
+                                   !CheckpointFile.isEmpty()))
+    {
+        qDebug() << "Error: the virtual clock needs a single run of a scenario with its recorded timing";
+        return 1;
+    }
+    if (parser.isSet("box") && parser.isSet("radius"))
+    {
+        qDebug() << "Error: a filter is either a box or a radius";
+        return 1;
+    }
+    GeoFilter Filter;
+    if (parser.isSet("box") && !Filter.ParseBox(parser.value("box")))
+    {
+        qDebug() << "Error: invalid box " << qPrintable(parser.value("box"));
+        return 1;
+    }
+    if (parser.isSet("radius") && !Filter.ParseRadius(parser.value("radius")))
+    {
+        qDebug() << "Error: invalid radius " << qPrintable(parser.value("radius"));
+        return 1;
+    }
 
     qDebug() << "XML Filename:      " << FileName;
     qDebug() << "FSD Serveraddress: " << ClientProcess::Server;
     qDebug() << "FSD Port:          " << ClientProcess::Port;
     qDebug() << "FSD Username:      " << ClientProcess::Username;
     qDebug() << "FSD Password:      " << ClientProcess::Password;
+    qDebug() << "Blast mode:        " << ClientProcess::Blast;
+    if (parser.isSet("rate"))
+    {
+        qDebug() << "Packet rate:       " << parser.value("rate").toInt();
+    }
+    qDebug() << "Copies:            " << parser.value("copies").toInt();
+    qDebug() << "Interim rate:      " << ClientProcess::InterimRate << "Hz";
+    qDebug() << "Catch up:          " << qPrintable(CatchUp);
+    if (ClientProcess::Phase != NaturalPhase)
+    {
+        qDebug() << "Phase:             " << qPrintable(Phase) << "every" << ClientProcess::PhasePeriod << "ms";
+    }
+    if (DispatchTimer::Virtual)
+    {
+        qDebug() << "Timer:             " << "virtual";
+    }
+    else if (DispatchTimer::Precise)
+    {
+        qDebug() << "Timer:             " << "precise, spin" << DispatchTimer::SpinWindow << "us";
+    }
+    if (ClientProcess::NullTransport)
+    {
+        qDebug() << "Transport:         " << "null";
+    }
+    if (parser.isSet("trace-sends"))
+    {
+        qDebug() << "Send trace:        " << parser.value("trace-sends");
+    }
+    if (ClientProcess::Limiter != 0)
+    {
+        qDebug() << "Limits per second: " << parser.value("limit-packets").toDouble() << "packets,"
+                 << parser.value("limit-bytes").toDouble() << "bytes," << parser.value("limit-positions").toDouble()
+                 << "positions," << parser.value("limit-text").toDouble() << "text";
+    }
 
-    qDebug() << "Loading Logfile!";
-    ClientContainer Cont(FileName);
+    if (parser.isSet("trace-sends") && !SendTrace::Instance().Open(parser.value("trace-sends")))
+    {
+        return 1;
+    }
+    // create the statistics in the main thread, the report timer lives here
+    RunStatistics &Statistics = RunStatistics::Instance();
+    ThreadHelper *closer = new ThreadHelper(parser.value("drain-timeout").toInt());
+    QTimer ReportTimer;
+    QObject::connect(&ReportTimer, &QTimer::timeout, &Statistics, &RunStatistics::Report);
+    // a stopped run still ends with the report of what was sent
+    SignalWatcher Watcher;
+    QObject::connect(&Watcher, &SignalWatcher::Stop, closer, &ThreadHelper::Drain);
+    QObject::connect(&Watcher, &SignalWatcher::Stop, &ReportTimer, &QTimer::stop);
 
-    QList<QThread *> Threads;
-    ThreadHelper *closer = new ThreadHelper(&Threads);
+    if (ClientProcess::Live)
+    {
+        // the clients start one by one as they show up in the log, copies
+        // and the area filter need the whole log and are left out
+        qDebug() << "Follow delay:      " << parser.value("follow-delay").toInt() << "ms";
+        qRegisterMetaType<pTimeUpdate>("pTimeUpdate");
+        LiveRelay Relay(FileName, parser.value("follow-delay").toInt(), closer);
+        if (!Relay.Start())
+        {
+            return 1;
+        }
+        QObject::connect(&Watcher, &SignalWatcher::Stop, &Relay, &LiveRelay::Stop);
+        ReportTimer.start(parser.value("interval").toInt() * 1000);
+        int result = a.exec();
+        EndRemainingClients(closer, result);
+        SessionPool::Instance().Clear();
+        Statistics.Report();
+        return Relay.HasFailed() ? 1 : result;
+    }
 
-    qDebug() << "Create and Start Threads";
-    for (ClientContainer::iterator iter = Cont.begin(); iter != Cont.end(); iter++)
+    qDebug() << "Loading Logfile!";
+    ClientContainer Cont;
+    if (IsScenarioFile(FileName))
+    {
+        Cont = ClientContainer(FileName, Filter);
+    }
+    else
     {
-        ClientProcess *process = 0;
-        if ((*iter)->GetType() == AirplaneType)
+        // the log is parsed line by line without writing a scenario first
+        FSInnReader Reader(FileName);
+        if (!Reader.ReadFile(Cont))
         {
-            process = new AirplaneClientProcess(*iter);
+            return 1;
         }
-        else if ((*iter)->GetType() == ControllerType)
+        Cont.PrepareForReplay();
+        Cont.Filter(Filter);
+    }
+    if (Filter.IsSet())
+    {
+        qDebug() << "Clients in area:   " << Cont.size();
+    }
+    ScenarioView View(Cont, parser.value("copies").toInt(), parser.value("lat-offset").toDouble(),
+                      parser.value("long-offset").toDouble(), parser.value("time-shift").toInt());
+    if (parser.isSet("loop"))
+    {
+        // a loop ends when the last copy of the longest client is done
+        int Duration = 0;
+        for (const pClient &client : Cont)
         {
-            process = new ControllerClientProcess(*iter);
+            Duration = qMax(Duration, client->GetDuration());
         }
-        if (process != 0)
+        int Shift = 0;
+        for (const ClientView &view : View)
         {
-            QThread *thread = new QThread();
-            QThread::connect(thread, &QThread::started, process, &ClientProcess::Run);
-            QThread::connect(thread, &QThread::finished, closer, &ThreadHelper::AllThreadsClosed);
-            QThread::connect(process, &ClientProcess::ClientFinished, thread, &QThread::quit);
-
-            process->moveToThread(thread);
-            thread->start();
+            Shift = qMax(Shift, view.GetTimeShift());
+        }
+        ClientProcess::LoopPeriod = qMax(Duration + Shift, MIN_LOOP_PERIOD);
+        ClientProcess::LoopRotation = parser.value("loop-rotate").toInt();
+        qDebug() << "Loop period:       " << ClientProcess::LoopPeriod / 1000.0 << "s";
+    }
 
-            Threads.append(thread);
+    // the checkpoint knows the scenario by its name and its client count
+    QString Scenario = QFileInfo(FileName).fileName();
+    Checkpoint Resume;
+    if (parser.isSet("resume"))
+    {
+        if (!Resume.Read(CheckpointFile))
+        {
+            return 1;
+        }
+        if (!Resume.Matches(Scenario, View.size()))
+        {
+            qDebug() << "Error: the checkpoint is from another scenario";
+            return 1;
         }
+        qDebug() << "Resume at:         " << Resume.GetTime() / 1000.0 << "s";
+    }
+
+    qDebug() << "Create and Start Threads";
+    QElapsedTimer RunClock;
+    RunClock.start();
+    for (ScenarioView::iterator iter = View.begin(); iter != View.end(); iter++)
+    {
+        closer->StartClient(*iter, parser.isSet("resume") ? &Resume : 0);
     }
     if (Cont.size() == 0)
     {
         qDebug() << "No Data!";
         return 0;
     }
-    return a.exec();
+    if (closer->GetRunning() == 0)
+    {
+        // no process would ever finish and quit the event loop
+        qDebug() << (parser.isSet("resume") ? "Nothing left to resume" : "No client to replay");
+        return 0;
+    }
+
+    ReportTimer.start(parser.value("interval").toInt() * 1000);
+    QTimer LoopTimer;
+    if (ClientProcess::LoopPeriod > 0)
+    {
+        QObject::connect(&LoopTimer, &QTimer::timeout, &Statistics, &RunStatistics::ReportLoop);
+        QObject::connect(&Watcher, &SignalWatcher::Stop, &LoopTimer, &QTimer::stop);
+        LoopTimer.start(ClientProcess::LoopPeriod);
+    }
+    QTimer CheckpointTimer;
+    auto WriteCheckpoint = [&]()
+    {
+        Checkpoint Point;
+        Point.SetScenario(Scenario, View.size());
+        Point.SetTime(Resume.GetTime() + static_cast<int>(RunClock.elapsed()));
+        closer->CollectProgress(Point);
+        Point.Write(CheckpointFile);
+    };
+    if (!CheckpointFile.isEmpty())
+    {
+        // a stopped run leaves the checkpoint of the moment it was stopped
+        QObject::connect(&CheckpointTimer, &QTimer::timeout, &CheckpointTimer, WriteCheckpoint);
+        QObject::connect(&Watcher, &SignalWatcher::Stop, &CheckpointTimer, WriteCheckpoint);
+        QObject::connect(&Watcher, &SignalWatcher::Stop, &CheckpointTimer, &QTimer::stop);
+        CheckpointTimer.start(parser.value("checkpoint-interval").toInt() * 1000);
+    }
+
+    int result = a.exec();
+    EndRemainingClients(closer, result);
+    if (!CheckpointFile.isEmpty() && !closer->IsDraining())
+    {
+        // all clients are done, nothing is left to resume
+        WriteCheckpoint();
+    }
+    if (DispatchTimer::Virtual)
+    {
+        qDebug() << "Simulated time:    " << VirtualClock::Instance().Now() / 1e9 << "s";
+    }
+    SessionPool::Instance().Clear();
+    Statistics.Report();
+    return result;
 }
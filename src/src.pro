@@ -4,3 +4,6 @@ CONFIG += ordered
 SUBDIRS += STLib
 SUBDIRS += STExport
 SUBDIRS += STd
+SUBDIRS += STServer
+SUBDIRS += STGen
+SUBDIRS += STAnalyze